@@ -21,12 +21,35 @@ SOURCES += \
     src/main.cpp \
     src/MainWindow.cpp \
     src/paperscope/PaperScope.cpp \
+    src/paperscope/PSProfiler.cpp \
+    src/paperscope/PSRenderLayer.cpp \
+    src/paperscope/PSTaskGroup.cpp \
     src/paperscope/capture/PSCalibrate.cpp \
     src/paperscope/capture/PSCapture.cpp \
+    src/paperscope/capture/PSFrameRing.cpp \
+    src/paperscope/capture/PSFrameDecoder.cpp \
+    src/paperscope/capture/PSMarkerTracker.cpp \
+    src/paperscope/capture/PSPlaneWarp.cpp \
+    src/paperscope/capture/source/PSFrameSource.cpp \
+    src/paperscope/capture/source/PSCameraSource.cpp \
+    src/paperscope/capture/source/PSVideoSource.cpp \
+    src/paperscope/capture/source/PSImageSequenceSource.cpp \
+    src/paperscope/capture/source/PSSyntheticSource.cpp \
+    src/paperscope/capture/source/PSGStreamerSource.cpp \
+    src/paperscope/capture/source/PSCameraFormat.cpp \
     src/paperscope/detect/PSDetect.cpp \
     src/paperscope/detect/PSCandidate.cpp \
+    src/paperscope/detect/PSChangeDetector.cpp \
+    src/paperscope/detect/PSPixelClassifier.cpp \
+    src/paperscope/detect/PSColorTable.cpp \
+    src/paperscope/detect/PSLocalThreshold.cpp \
+    src/paperscope/detect/PSShapeClassifier.cpp \
+    src/paperscope/detect/PSShapeCache.cpp \
     src/paperscope/describe/PSDescribe.cpp \
     src/paperscope/describe/PSObject.cpp \
+    src/paperscope/describe/PSSpatialGrid.cpp \
+    src/paperscope/describe/PSColorPalette.cpp \
+    src/paperscope/describe/PSSceneDiff.cpp \
     src/ui/menu/MainMenu.cpp \
     src/ui/navi/MainNavi.cpp \
     src/ui/renderer/Renderer.cpp \
@@ -41,14 +64,40 @@ HEADERS += \
     src/global/Api.h \
     src/global/Broadcast.h \
     src/paperscope/PaperScope.h \
+    src/paperscope/PSProfiler.h \
+    src/paperscope/PSRenderLayer.h \
+    src/paperscope/PSTaskGroup.h \
     src/paperscope/PSTrackingMode.h \
     src/paperscope/PSViewMode.h \
     src/paperscope/capture/PSCalibrate.h \
     src/paperscope/capture/PSCapture.h \
+    src/paperscope/capture/PSFrame.h \
+    src/paperscope/capture/PSFrameRing.h \
+    src/paperscope/capture/PSFrameDecoder.h \
+    src/paperscope/capture/PSMarkerTracker.h \
+    src/paperscope/capture/PSPlaneWarp.h \
+    src/paperscope/capture/source/PSFramePacing.h \
+    src/paperscope/capture/source/PSPixelFormat.h \
+    src/paperscope/capture/source/PSFrameSource.h \
+    src/paperscope/capture/source/PSCameraSource.h \
+    src/paperscope/capture/source/PSVideoSource.h \
+    src/paperscope/capture/source/PSImageSequenceSource.h \
+    src/paperscope/capture/source/PSSyntheticSource.h \
+    src/paperscope/capture/source/PSGStreamerSource.h \
+    src/paperscope/capture/source/PSCameraFormat.h \
     src/paperscope/detect/PSDetect.h \
     src/paperscope/detect/PSCandidate.h \
+    src/paperscope/detect/PSChangeDetector.h \
+    src/paperscope/detect/PSPixelClassifier.h \
+    src/paperscope/detect/PSColorTable.h \
+    src/paperscope/detect/PSLocalThreshold.h \
+    src/paperscope/detect/PSShapeClassifier.h \
+    src/paperscope/detect/PSShapeCache.h \
     src/paperscope/describe/PSDescribe.h \
     src/paperscope/describe/PSObject.h \
+    src/paperscope/describe/PSSpatialGrid.h \
+    src/paperscope/describe/PSColorPalette.h \
+    src/paperscope/describe/PSSceneDiff.h \
     src/ui/menu/MainMenu.h \
     src/ui/navi/MainNavi.h \
     src/ui/renderer/Renderer.h \
@@ -90,11 +139,29 @@ macx {
     BundleFiles.files += \
         $$PWD/thirdparty/tensorflow-lite/lib/mac/libtensorflowlite.dylib \
         #$$PWD/thirdparty/tensorflow-lite/lib/mac/libtensorflowlite_intel.dylib \
-        $$PWD/resources/keras/shape-classifier_v4.tflite
+        $$PWD/resources/keras/shape-classifier_v4.tflite \
+        $$PWD/resources/keras/shape-classifier_v4_int8.tflite
     QMAKE_BUNDLE_DATA += BundleFiles
 }
 
 
+#########################################
+#	LINUX
+#########################################
+
+unix:!macx {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+
+    LIBS += -L$$PWD/thirdparty/tensorflow-lite/lib/linux -ltensorflowlite
+    DEPENDPATH += $$PWD/thirdparty/tensorflow-lite/lib/linux
+
+    # native v4l2 camera backend
+    SOURCES += src/paperscope/capture/source/PSV4L2Source.cpp
+    HEADERS += src/paperscope/capture/source/PSV4L2Source.h
+}
+
+
 #########################################
 #	WINDOWS
 #########################################
@@ -211,6 +211,17 @@
 	}
 
 
+	/**
+	 * Values of this key only apply to the current run, e.g. command line options. They are neither written
+	 * by save() nor replaced by load().
+	 */
+
+	void Settings::setRuntime(QString key) {
+
+		runtimeKeys.insert(key);
+	}
+
+
 
 /*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -224,6 +235,7 @@
 		QSettings settings;
 		QMap<QString, QVariant>::iterator i;
 		for (i = unsavedSettings.begin(); i != unsavedSettings.end(); ++i) {
+			if(runtimeKeys.contains(i.key())) { continue; }
 			settings.setValue(i.key(), i.value());
 		}
 	}
@@ -234,6 +246,7 @@
 		QSettings settings;
 		QStringList keys = settings.allKeys();
 		for(int i = 0; i < keys.size(); i++) {
+			if(runtimeKeys.contains(keys[i])) { continue; }
 			unsavedSettings[keys[i]] = settings.value(keys[i]);
 		}
 	}
\ No newline at end of file
@@ -10,6 +10,7 @@
 	// Qt
 	#include <QObject>
 	#include <QMap>
+	#include <QSet>
 	#include <QVariant>
 	#include <QJsonObject>
 
@@ -52,6 +53,9 @@ class Settings : public QObject {
 		QJsonObject saveJsonObject(QString key, QJsonObject value);
 		std::vector<cv::Point2f> savePoints(QString key, std::vector<cv::Point2f> value);
 
+		// runtime
+		void setRuntime(QString key);
+
 
 	private:
 	
@@ -62,6 +66,7 @@ class Settings : public QObject {
 
 		// changes
 		QMap<QString, QVariant> unsavedSettings;
+		QSet<QString> runtimeKeys;
 
 
 	signals:
@@ -8,9 +8,11 @@
 	// Qt
 	#include <QApplication>
 	#include <QFile>
+	#include <QCommandLineParser>
 
 	// app
 	#include "MainWindow.h"
+	#include "global/Settings.h"
 
 
 
@@ -34,6 +36,75 @@
 		file.open(QFile::ReadOnly);
 		app.setStyleSheet(QLatin1String(file.readAll()));
 
+		// replay and benchmark options
+		QCommandLineParser parser;
+		parser.addHelpOption();
+		parser.addOption({"source", "Frame source: camera, video, images, synthetic or gstreamer.", "type", "camera"});
+		parser.addOption({"source-path", "Video file, image directory or GStreamer pipeline.", "path"});
+		parser.addOption({"pacing", "Replay speed of recorded sources: realtime or fast.", "mode", "realtime"});
+		parser.addOption({"benchmark", "Log per-stage processing times."});
+		parser.addOption({"decode-scale", "Decode MJPEG frames at 1/2 or 1/4 resolution for the marker search.", "scale"});
+		parser.addOption({"decode-threads", "Number of MJPEG decode threads, 0 decodes on the capture thread.", "count"});
+		parser.addOption({"raw-yuv", "Process NV12/YUYV camera frames without converting the full frame to BGR."});
+		parser.addOption({"plane-width", "Width of the warped table plane in pixels.", "pixels"});
+		parser.addOption({"detect-width", "Width of the coarse detection level, 0 detects on the full plane.", "pixels"});
+		parser.addOption({"change-threshold", "Gray level difference that marks a plane tile as changed, 0 processes every frame completely.", "level"});
+		parser.addOption({"detect-tile", "Tile size for parallel detection in pixels, 0 processes the plane as a whole.", "pixels"});
+		parser.addOption({"detect-extractor", "Outer contour extraction: components or contours (full contour hierarchy).", "method"});
+		parser.addOption({"threshold-method", "Threshold of the edge boxes: otsu, sauvola or bradley.", "method"});
+		parser.addOption({"synthetic-pieces", "Fill the synthetic table with a grid of small pieces, at most 159.", "count"});
+		parser.addOption({"pixel-kernel", "Pixel classification: simd (default), lut, reference or validate the simd kernel against the reference.", "mode"});
+		parser.addOption({"classifier-model", "Shape classifier model: float, int8 or auto to benchmark both.", "model"});
+		parser.addOption({"classifier-delegate", "Shape classifier backend: xnnpack, none or auto to benchmark both.", "delegate"});
+		parser.addOption({"classifier-threads", "Threads of the shape classifier, 0 benchmarks one thread against all cores.", "count"});
+		parser.addOption({"classifier-cache", "Reuse the class of unchanged shapes: on or off.", "mode"});
+		parser.addOption({"classifier-budget", "Shapes classified per frame, 0 classifies all shapes of a frame at once.", "count"});
+		parser.addOption({"classifier-queue", "Shapes that may wait for classification before the budget is exceeded.", "count"});
+		parser.addOption({"track-spawn", "Frames a new object has to be seen before it is sent to the server.", "frames"});
+		parser.addOption({"track-kill", "Frames a confirmed object survives without a matching candidate.", "frames"});
+		parser.addOption({"track-gate", "Distance in pixels between predicted and detected center of a match.", "pixels"});
+		parser.addOption({"color-interval", "Frames between color updates of an unchanged object, 0 only updates moved objects.", "frames"});
+		parser.addOption({"scene-interval", "Minimum time between scene requests.", "ms"});
+		parser.addOption({"scene-tolerance", "Distance an object point has to move before it is sent again, relative to the plane size.", "distance"});
+		parser.process(app);
+
+		// command line values only apply to this run and are never written by "Save settings"
+		QStringList runtimeKeys = {
+			"capture_source", "capture_path", "capture_pacing", "benchmark", "capture_raw_yuv", "decode_scale", "decode_threads",
+			"plane_width", "detect_width", "change_threshold", "detect_tile", "detect_extractor", "threshold_method", "synthetic_pieces",
+			"pixel_kernel", "classifier_model", "classifier_delegate", "classifier_threads", "classifier_cache", "classifier_budget",
+			"classifier_queue", "track_spawn", "track_kill", "track_gate", "color_interval", "scene_interval", "scene_tolerance"
+		};
+		for(const QString &key : runtimeKeys) { Settings::instance()->setRuntime(key); }
+
+		Settings::instance()->saveString("capture_source", parser.value("source"));
+		Settings::instance()->saveString("capture_path", parser.value("source-path"));
+		Settings::instance()->saveString("capture_pacing", parser.value("pacing"));
+		Settings::instance()->saveBool("benchmark", parser.isSet("benchmark"));
+		Settings::instance()->saveBool("capture_raw_yuv", parser.isSet("raw-yuv"));
+		if(parser.isSet("decode-scale")) { Settings::instance()->saveInt("decode_scale", parser.value("decode-scale").toInt()); }
+		if(parser.isSet("decode-threads")) { Settings::instance()->saveInt("decode_threads", parser.value("decode-threads").toInt()); }
+		if(parser.isSet("plane-width")) { Settings::instance()->saveInt("plane_width", parser.value("plane-width").toInt()); }
+		if(parser.isSet("detect-width")) { Settings::instance()->saveInt("detect_width", parser.value("detect-width").toInt()); }
+		if(parser.isSet("change-threshold")) { Settings::instance()->saveInt("change_threshold", parser.value("change-threshold").toInt()); }
+		if(parser.isSet("detect-tile")) { Settings::instance()->saveInt("detect_tile", parser.value("detect-tile").toInt()); }
+		if(parser.isSet("detect-extractor")) { Settings::instance()->saveString("detect_extractor", parser.value("detect-extractor")); }
+		if(parser.isSet("threshold-method")) { Settings::instance()->saveString("threshold_method", parser.value("threshold-method")); }
+		if(parser.isSet("synthetic-pieces")) { Settings::instance()->saveInt("synthetic_pieces", parser.value("synthetic-pieces").toInt()); }
+		if(parser.isSet("pixel-kernel")) { Settings::instance()->saveString("pixel_kernel", parser.value("pixel-kernel")); }
+		if(parser.isSet("classifier-model")) { Settings::instance()->saveString("classifier_model", parser.value("classifier-model")); }
+		if(parser.isSet("classifier-delegate")) { Settings::instance()->saveString("classifier_delegate", parser.value("classifier-delegate")); }
+		if(parser.isSet("classifier-threads")) { Settings::instance()->saveInt("classifier_threads", parser.value("classifier-threads").toInt()); }
+		if(parser.isSet("classifier-cache")) { Settings::instance()->saveBool("classifier_cache", parser.value("classifier-cache") == "on"); }
+		if(parser.isSet("classifier-budget")) { Settings::instance()->saveInt("classifier_budget", parser.value("classifier-budget").toInt()); }
+		if(parser.isSet("classifier-queue")) { Settings::instance()->saveInt("classifier_queue", parser.value("classifier-queue").toInt()); }
+		if(parser.isSet("track-spawn")) { Settings::instance()->saveInt("track_spawn", parser.value("track-spawn").toInt()); }
+		if(parser.isSet("track-kill")) { Settings::instance()->saveInt("track_kill", parser.value("track-kill").toInt()); }
+		if(parser.isSet("track-gate")) { Settings::instance()->saveInt("track_gate", parser.value("track-gate").toInt()); }
+		if(parser.isSet("color-interval")) { Settings::instance()->saveInt("color_interval", parser.value("color-interval").toInt()); }
+		if(parser.isSet("scene-interval")) { Settings::instance()->saveInt("scene_interval", parser.value("scene-interval").toInt()); }
+		if(parser.isSet("scene-tolerance")) { Settings::instance()->saveFloat("scene_tolerance", parser.value("scene-tolerance").toFloat()); }
+
 		MainWindow mainWindow;
 
 		return app.exec();
@@ -0,0 +1,178 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSProfiler.h"
+
+	// Qt
+	#include <QDebug>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SINGLETON
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	// static properties
+	bool PSProfiler::instanceFlag = false;
+	PSProfiler* PSProfiler::profilerInstance = nullptr;
+
+
+	PSProfiler* PSProfiler::instance() {
+
+		if (!instanceFlag) {
+			profilerInstance = new PSProfiler();
+			instanceFlag = true;
+		}
+
+		return profilerInstance;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSProfiler::PSProfiler()
+		: reportInterval(300),
+		  enabled(false),
+		  needsReset(false),
+		  frames(0),
+		  frameTick(0)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PROFILING
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSProfiler::setEnabled(bool enabled) {
+
+		// stats are cleared by the processing thread on the next frame
+		this->enabled = enabled;
+		needsReset = true;
+	}
+
+
+	bool PSProfiler::isEnabled() {
+
+		return enabled;
+	}
+
+
+	void PSProfiler::begin(const std::string &stage) {
+
+		if(!enabled) { return; }
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		stages[stage].tick = cv::getTickCount();
+	}
+
+
+	void PSProfiler::end(const std::string &stage) {
+
+		if(!enabled) { return; }
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		Stage &s = stages[stage];
+		if(s.tick == 0) { return; }
+
+		double ms = (cv::getTickCount() - s.tick) * 1000.0 / cv::getTickFrequency();
+		s.total += ms;
+		s.max = std::max(s.max, ms);
+		s.calls++;
+		s.tick = 0;
+	}
+
+
+	/**
+	 * Mark the end of a processing loop iteration.
+	 */
+
+	void PSProfiler::frame() {
+
+		if(!enabled) { return; }
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		if(needsReset) { reset(); }
+
+		if(frameTick == 0) { frameTick = cv::getTickCount(); }
+
+		frames++;
+		if(frames >= reportInterval) { report(); }
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	METRICS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSProfiler::count(const std::string &metric, double value) {
+
+		if(!enabled) { return; }
+
+		// detection tiles count from worker threads
+		std::lock_guard<std::mutex> lock(statsMutex);
+		metrics[metric] += value;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	REPORT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSProfiler::report() {
+
+		if(frames == 0) { return; }
+
+		double seconds = (cv::getTickCount() - frameTick) / cv::getTickFrequency();
+		qDebug().noquote() << "profiler:" << frames << "frames," << QString::number(frames / seconds, 'f', 1) << "fps";
+
+		// average time per call of every stage
+		for(auto &[name, s] : stages) {
+			if(s.calls == 0) { continue; }
+			qDebug().noquote() << "  " << QString::fromStdString(name) << QString::number(s.total / s.calls, 'f', 2) << "ms avg" << QString::number(s.max, 'f', 2) << "ms max" << s.calls << "calls";
+		}
+
+		// metrics per frame
+		for(auto &[name, value] : metrics) {
+			qDebug().noquote() << "  " << QString::fromStdString(name) << QString::number(value / frames, 'f', 2) << "per frame";
+		}
+
+		reset();
+		frameTick = cv::getTickCount();
+	}
+
+
+	void PSProfiler::reset() {
+
+		stages.clear();
+		metrics.clear();
+		frames = 0;
+		frameTick = 0;
+		needsReset = false;
+	}
@@ -0,0 +1,78 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <atomic>
+	#include <map>
+	#include <mutex>
+	#include <string>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Collects per-stage timings of the processing loop and logs averages every reportInterval frames.
+ * All calls are no-ops while the profiler is disabled. Calls are serialized, so worker threads may record
+ * as well, but a stage keeps a single start tick and must not be timed by two threads at once.
+ */
+
+class PSProfiler {
+
+	public:
+
+		static PSProfiler* instance();
+		~PSProfiler() { instanceFlag = false; };
+
+		// profiling
+		void setEnabled(bool enabled);
+		bool isEnabled();
+		void begin(const std::string &stage);
+		void end(const std::string &stage);
+		void frame();
+
+		// metrics
+		void count(const std::string &metric, double value = 1.0);
+
+		// report
+		void report();
+		int reportInterval;
+
+
+	private:
+
+		// singleton
+		static bool instanceFlag;
+		static PSProfiler* profilerInstance;
+		PSProfiler();
+
+		// stages
+		struct Stage {
+			int64 tick = 0;
+			double total = 0.0;
+			double max = 0.0;
+			int calls = 0;
+		};
+		std::map<std::string, Stage> stages;
+		std::map<std::string, double> metrics;
+		void reset();
+		std::atomic<bool> enabled;
+		std::atomic<bool> needsReset;
+		std::mutex statsMutex;
+		int frames;
+		int64 frameTick;
+};
@@ -0,0 +1,285 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSRenderLayer.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSRenderLayer::PSRenderLayer()
+		: ownsBase(false),
+		  fadeFactor(1.0),
+		  scaling(1.0f)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	BASE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Start a new layer on top of mat. Removes all draw commands of the previous base.
+	 */
+
+	void PSRenderLayer::setBase(cv::Mat mat) {
+
+		base = mat;
+		size = mat.size();
+		ownsBase = false;
+		fadeFactor = 1.0;
+		commands.clear();
+	}
+
+
+	/**
+	 * Black base of the given size, no memory is allocated until composition.
+	 */
+
+	void PSRenderLayer::clear(cv::Size newSize) {
+
+		setBase(cv::Mat());
+		size = newSize;
+	}
+
+
+	/**
+	 * Copy-on-write access to the base in BGR, only needed for raster operations that can not be recorded.
+	 */
+
+	cv::Mat& PSRenderLayer::edit() {
+
+		if(!ownsBase) {
+			cv::Mat copy;
+			if(base.empty()) { copy = cv::Mat::zeros(size, CV_8UC3); }
+			else if(base.channels() == 1) { cv::cvtColor(base, copy, cv::COLOR_GRAY2BGR); }
+			else { copy = base.clone(); }
+
+			base = copy;
+			ownsBase = true;
+		}
+
+		return base;
+	}
+
+
+	/**
+	 * Darken the base, applied at view resolution.
+	 */
+
+	void PSRenderLayer::fade(double factor) {
+
+		fadeFactor *= factor;
+	}
+
+
+	cv::Size PSRenderLayer::getSize() {
+
+		return size;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	DRAW COMMANDS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSRenderLayer::drawLine(cv::Point2f from, cv::Point2f to, cv::Scalar color, int thickness) {
+
+		Command command;
+		command.type = CommandType::Line;
+		command.points = { from, to };
+		command.color = color;
+		command.thickness = thickness;
+		addCommand(command);
+	}
+
+
+	void PSRenderLayer::drawPolygon(std::vector<cv::Point> points, cv::Scalar color, int thickness) {
+
+		std::vector<cv::Point2f> polygon(points.begin(), points.end());
+		drawPolygon(polygon, color, thickness);
+	}
+
+
+	void PSRenderLayer::drawPolygon(std::vector<cv::Point2f> points, cv::Scalar color, int thickness) {
+
+		Command command;
+		command.type = CommandType::Polygon;
+		command.points = points;
+		command.color = color;
+		command.thickness = thickness;
+		addCommand(command);
+	}
+
+
+	void PSRenderLayer::drawRect(cv::Rect rect, cv::Scalar color, int thickness) {
+
+		Command command;
+		command.type = CommandType::Rect;
+		command.points = { rect.tl(), rect.br() };
+		command.color = color;
+		command.thickness = thickness;
+		addCommand(command);
+	}
+
+
+	/**
+	 * Negative thickness draws a filled circle.
+	 */
+
+	void PSRenderLayer::drawCircle(cv::Point2f center, float radius, cv::Scalar color, int thickness) {
+
+		Command command;
+		command.type = CommandType::Circle;
+		command.points = { center };
+		command.radius = radius;
+		command.color = color;
+		command.thickness = thickness;
+		addCommand(command);
+	}
+
+
+	void PSRenderLayer::drawText(std::string text, cv::Point2f position, double fontScale, cv::Scalar color, int thickness) {
+
+		Command command;
+		command.type = CommandType::Text;
+		command.points = { position };
+		command.text = text;
+		command.fontScale = fontScale;
+		command.color = color;
+		command.thickness = thickness;
+		addCommand(command);
+	}
+
+
+	/**
+	 * Inset image (e.g. histogram), image must stay unchanged until composition.
+	 */
+
+	void PSRenderLayer::drawImage(cv::Mat image, cv::Point position) {
+
+		Command command;
+		command.type = CommandType::Image;
+		command.points = { position };
+		command.image = image;
+		addCommand(command);
+	}
+
+
+	void PSRenderLayer::addCommand(Command command) {
+
+		commands.push_back(command);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	COMPOSITION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Scale the base to fit the view (same fit as the renderer) and replay all draw commands at view resolution.
+	 * Returns a new image, so the result can be handed to the gui thread while the next frame is processed.
+	 */
+
+	cv::Mat PSRenderLayer::compose(cv::Size viewSize) {
+
+		int w = size.width;
+		int h = size.height;
+		if(w == 0 || h == 0) { return cv::Mat(); }
+
+		// fit view
+		if(w/h < viewSize.width/viewSize.height) { scaling = viewSize.width * 1.0f / w; }
+		else { scaling = viewSize.height * 1.0f / h; }
+		cv::Size scaledSize(cvRound(w * scaling), cvRound(h * scaling));
+		if(scaledSize.area() == 0) { return cv::Mat(); }
+
+		// scale base
+		cv::Mat view;
+		if(base.empty()) {
+			view = cv::Mat::zeros(scaledSize, CV_8UC3);
+		}
+		else {
+			cv::resize(base, view, scaledSize, 0, 0, cv::INTER_AREA);
+			if(view.channels() == 1) { cv::cvtColor(view, view, cv::COLOR_GRAY2BGR); }
+		}
+		if(fadeFactor != 1.0) { view.convertTo(view, -1, fadeFactor); }
+
+		for(Command &command : commands) { drawCommand(view, command); }
+
+		return view;
+	}
+
+
+	void PSRenderLayer::drawCommand(cv::Mat &view, Command &command) {
+
+		// points and sizes to view resolution
+		std::vector<cv::Point> points;
+		for(cv::Point2f &point : command.points) { points.push_back(point * scaling); }
+		int thickness = command.thickness < 0 ? command.thickness : std::max(1, cvRound(command.thickness * scaling));
+
+		switch(command.type) {
+
+			case CommandType::Line:
+				cv::line(view, points[0], points[1], command.color, thickness, cv::LINE_AA);
+				break;
+
+			case CommandType::Polygon:
+				cv::polylines(view, points, true, command.color, thickness, cv::LINE_AA);
+				break;
+
+			case CommandType::Rect:
+				cv::rectangle(view, points[0], points[1], command.color, thickness);
+				break;
+
+			case CommandType::Circle:
+				cv::circle(view, points[0], std::max(1, cvRound(command.radius * scaling)), command.color, thickness, cv::LINE_AA);
+				break;
+
+			case CommandType::Text:
+				cv::putText(view, command.text, points[0], cv::FONT_HERSHEY_SIMPLEX, command.fontScale * scaling, command.color, thickness, cv::LINE_AA);
+				break;
+
+			case CommandType::Image: {
+				cv::Mat scaled;
+				cv::Size imageSize(cvRound(command.image.cols * scaling), cvRound(command.image.rows * scaling));
+				cv::Rect roi = cv::Rect(points[0], imageSize) & cv::Rect(0, 0, view.cols, view.rows);
+				if(roi.area() == 0) { break; }
+				cv::resize(command.image, scaled, imageSize, 0, 0, cv::INTER_AREA);
+				scaled(cv::Rect(0, 0, roi.width, roi.height)).copyTo(view(roi));
+				break;
+			}
+		}
+	}
+
+
+	/**
+	 * View pixels per base pixel of the last composition.
+	 */
+
+	float PSRenderLayer::getScaling() {
+
+		return scaling;
+	}
@@ -0,0 +1,93 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <string>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Overlay of the renderer. The pipeline sets a base frame (a shared header, never written) and records
+ * draw commands in base coordinates. Nothing is drawn until compose() scales the base to the view size
+ * and replays the commands, so no full resolution copy is made if no view is active. Raster operations
+ * on the base get a private copy through edit().
+ */
+
+class PSRenderLayer {
+
+	public:
+
+		PSRenderLayer();
+
+		// base
+		void setBase(cv::Mat mat);
+		void clear(cv::Size size);
+		cv::Mat& edit();
+		void fade(double factor);
+		cv::Size getSize();
+
+		// draw commands
+		void drawLine(cv::Point2f from, cv::Point2f to, cv::Scalar color, int thickness = 1);
+		void drawPolygon(std::vector<cv::Point> points, cv::Scalar color, int thickness = 1);
+		void drawPolygon(std::vector<cv::Point2f> points, cv::Scalar color, int thickness = 1);
+		void drawRect(cv::Rect rect, cv::Scalar color, int thickness = 1);
+		void drawCircle(cv::Point2f center, float radius, cv::Scalar color, int thickness = 1);
+		void drawText(std::string text, cv::Point2f position, double fontScale, cv::Scalar color, int thickness = 1);
+		void drawImage(cv::Mat image, cv::Point position);
+
+		// composition
+		cv::Mat compose(cv::Size viewSize);
+		float getScaling();
+
+
+	private:
+
+		// base
+		cv::Mat base;
+		cv::Size size;
+		bool ownsBase;
+		double fadeFactor;
+
+		// commands
+		enum class CommandType {
+			Line,
+			Polygon,
+			Rect,
+			Circle,
+			Text,
+			Image
+		};
+		struct Command {
+			CommandType type;
+			std::vector<cv::Point2f> points;
+			cv::Scalar color;
+			int thickness = 1;
+			float radius = 0.0f;
+			double fontScale = 1.0;
+			std::string text;
+			cv::Mat image;
+		};
+		void addCommand(Command command);
+		void drawCommand(cv::Mat &view, Command &command);
+		std::vector<Command> commands;
+
+		// composition
+		float scaling;
+};
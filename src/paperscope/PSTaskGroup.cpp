@@ -0,0 +1,83 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSTaskGroup.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSTaskGroup::PSTaskGroup(QThreadPool *pool)
+		: pool(pool),
+		  pending(0),
+		  error(nullptr)
+	{
+
+	}
+
+
+	/**
+	 * Tasks capture state of the caller, the group must never be left before they are done.
+	 */
+
+	PSTaskGroup::~PSTaskGroup() {
+
+		std::unique_lock<std::mutex> lock(taskMutex);
+		taskCondition.wait(lock, [this]() { return pending == 0; });
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TASKS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSTaskGroup::run(std::function<void()> task) {
+
+		if(!pool || pool->maxThreadCount() < 2) {
+			task();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			pending++;
+		}
+
+		pool->start([this, task]() {
+
+			std::exception_ptr taskError = nullptr;
+			try { task(); }
+			catch(...) { taskError = std::current_exception(); }
+
+			std::lock_guard<std::mutex> lock(taskMutex);
+			if(taskError && !error) { error = taskError; }
+			pending--;
+			taskCondition.notify_all();
+		});
+	}
+
+
+	void PSTaskGroup::wait() {
+
+		std::unique_lock<std::mutex> lock(taskMutex);
+		taskCondition.wait(lock, [this]() { return pending == 0; });
+
+		if(error) {
+			std::exception_ptr taskError = error;
+			error = nullptr;
+			std::rethrow_exception(taskError);
+		}
+	}
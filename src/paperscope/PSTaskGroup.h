@@ -0,0 +1,54 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <condition_variable>
+	#include <exception>
+	#include <functional>
+	#include <mutex>
+
+	// Qt
+	#include <QThreadPool>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Runs independent branches of a frame on a thread pool. The calling thread keeps working on its own
+ * branch and joins the group with wait(), exceptions of a task are rethrown there. Tasks run inline if
+ * the pool has a single thread.
+ */
+
+class PSTaskGroup {
+
+	public:
+
+		PSTaskGroup(QThreadPool *pool = QThreadPool::globalInstance());
+		~PSTaskGroup();
+
+		// tasks
+		void run(std::function<void()> task);
+		void wait();
+
+
+	private:
+
+		// tasks
+		QThreadPool *pool;
+		int pending;
+		std::exception_ptr error;
+		std::mutex taskMutex;
+		std::condition_variable taskCondition;
+};
@@ -28,7 +28,7 @@
 		  psDescribe(nullptr),
 		  matTracking(nullptr),
 		  trackingMode(PSTrackingMode::None),
-		  matRender(nullptr),
+		  renderLayer(nullptr),
 		  renderMode(RenderMode::Camera)
 	{
 
@@ -43,7 +43,7 @@
 		delete psDescribe;
 
 		delete matTracking;
-		delete matRender;
+		delete renderLayer;
 	}
 	
 
@@ -63,7 +63,7 @@
 		psDescribe = new PSDescribe();
 
 		matTracking = new cv::Mat();
-		matRender = new cv::Mat();
+		renderLayer = new PSRenderLayer();
 
 		initSettings();
 
@@ -87,15 +87,29 @@
 			}
 
 			startFpsTimer();
+			PSProfiler *profiler = PSProfiler::instance();
 			
 			// update paperscope
-			psCapture->update(matTracking, matRender, trackingMode);
-			bool wait = psCalibrate->update(matTracking, matRender, trackingMode);
-			psDetect->update(matTracking, matRender, trackingMode);
-			psDescribe->update(matTracking, matRender, psDetect->matStreets, trackingMode, psDetect->candidates);
+			profiler->begin("capture");
+			psCapture->update(matTracking, renderLayer, trackingMode);
+			profiler->end("capture");
+
+			bool wait = psCalibrate->update(matTracking, renderLayer, trackingMode);
+
+			profiler->begin("detect");
+			psDetect->update(matTracking, renderLayer, trackingMode);
+			profiler->end("detect");
+
+			profiler->begin("describe");
+			psDescribe->update(matTracking, renderLayer, psDetect->matStreets, trackingMode, psDetect->candidates);
+			profiler->end("describe");
 
 			// finish loop
+			profiler->begin("render");
 			updateRenderer();
+			profiler->end("render");
+			measureLatency();
+			profiler->frame();
             if(wait) { QThread::msleep(2000); }
 		}
 
@@ -202,8 +216,11 @@
 	void PaperScope::updateRenderer() {
 
 		if(renderMode == RenderMode::Camera || renderMode == RenderMode::PaperScope) {
-			drawFpsTimer();	
-			emit updated(*matRender, psCapture->currentImagePoints);
+			drawFpsTimer();
+
+			// draw overlay at view resolution, nothing is composed without active view
+			cv::Mat view = renderLayer->compose(cv::Size(720, 405));
+			emit updated(view, psCapture->currentImagePoints, renderLayer->getScaling());
 		}
 	}
 
@@ -218,6 +235,8 @@
 
 	void PaperScope::initSettings() {
 
+		PSProfiler::instance()->setEnabled(Settings::instance()->getBool("benchmark", false));
+
 		connect(Settings::instance(), &Settings::settingsUpdated, this, &PaperScope::onSettingsUpdated);
 	}
 
@@ -231,7 +250,10 @@
 
 		if(key == "renderMode") { 
 			renderMode = (RenderMode) value.toInt();
-		}	
+		}
+		else if(key == "benchmark") {
+			PSProfiler::instance()->setEnabled(value.toBool());
+		}
 	}
 
 
@@ -249,13 +271,27 @@
 	}
 
 
+	/**
+	 * Time from frame capture (driver timestamp if available) to the end of the processing loop.
+	 */
+
+	void PaperScope::measureLatency() {
+
+		int64 timestamp = psCapture->getFrameTimestamp();
+		if(timestamp == 0) { return; }
+
+		double latency = (PSFrameSource::now() - timestamp) / 1000.0;
+		PSProfiler::instance()->count("capture-to-output ms", latency);
+	}
+
+
 	void PaperScope::drawFpsTimer() {
 
-		if(!matRender || trackingMode != PSTrackingMode::Tracking) { return; }
+		if(!renderLayer || trackingMode != PSTrackingMode::Tracking) { return; }
 
 		// generate fps string output		
 		int fps = (int) cv::getTickFrequency() / (cv::getTickCount() - fpsTick);
-		std::string output = "FPS: " + std::to_string(fps);
+		std::string output = "FPS: " + std::to_string(fps) + "  Dropped: " + std::to_string(psCapture->getDroppedFrames());
 
-		cv::putText(*matRender, output, cv::Point(30, 40), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2, cv::LINE_AA);
+		renderLayer->drawText(output, cv::Point(30, 40), 1.0, cv::Scalar(0, 255, 0), 2);
 	}
@@ -17,6 +17,8 @@
 
 	// App
 	#include "PSTrackingMode.h"
+	#include "PSProfiler.h"
+	#include "PSRenderLayer.h"
 	#include "capture/PSCapture.h"
 	#include "capture/PSCalibrate.h"
 	#include "detect/PSDetect.h"
@@ -66,7 +68,7 @@ class PaperScope : public QThread {
 
 		// renderer
 		void updateRenderer();
-		cv::Mat *matRender;
+		PSRenderLayer *renderLayer;
 		RenderMode renderMode;
 
 		// settings
@@ -75,12 +77,13 @@ class PaperScope : public QThread {
 		// fps
 		void startFpsTimer();
 		void drawFpsTimer();
+		void measureLatency();
 		int64 fpsTick;
 
 
 	signals:
 		
-		void updated(cv::Mat mat, std::vector<cv::Point2f> points);
+		void updated(cv::Mat mat, std::vector<cv::Point2f> points, float scaling);
 		void trackingModeChanged(PSTrackingMode newMode, PSTrackingMode oldMode);
 
 
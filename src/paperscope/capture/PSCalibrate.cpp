@@ -52,7 +52,7 @@
 	}
 
 
-	bool PSCalibrate::update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode) {
+	bool PSCalibrate::update(cv::Mat *mTracking, PSRenderLayer *renderLayer, PSTrackingMode trackingMode) {
 		
 		if(trackingMode != PSTrackingMode::Calibrate) { return false; }
 
@@ -62,14 +62,14 @@
 
 		// draw detected corners count
 		std::string count = std::to_string(detectedCorners.size()) + "/" + std::to_string(frameCount);
-		cv::putText(*mRender, count, cv::Point(30, 40), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255,255,0), 4, cv::LINE_AA);
+		renderLayer->drawText(count, cv::Point(30, 40), 1, cv::Scalar(255,255,0), 4);
 		
 		// update timer
 		timeCount += time * 1000;
 		if(timeCount < 7000) { 
 			// draw countdown
 			int countdown = 7 - timeCount / 1000;
-			cv::putText(*mRender, std::to_string(countdown), cv::Point(30, 80), cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255,255,0), 4, cv::LINE_AA);
+			renderLayer->drawText(std::to_string(countdown), cv::Point(30, 80), 1, cv::Scalar(255,255,0), 4);
 			return false;; 
 		}
 		timeCount = 0;
@@ -78,7 +78,7 @@
 		std::vector<cv::Point2f> corners;
 		bool success = cv::findChessboardCorners(*mTracking, cv::Size(9,6), corners);
 		if(!success) { return false; }
-		cv::drawChessboardCorners(*mRender, cv::Size(9,6), corners, success);
+		cv::drawChessboardCorners(renderLayer->edit(), cv::Size(9,6), corners, success);
 
 		// save corners with subpixel accuracy
 		cv::Mat gray;
@@ -15,6 +15,7 @@
 
 	// App
 	#include "../PSTrackingMode.h"
+	#include "../PSRenderLayer.h"
 
 
 
@@ -36,7 +37,7 @@ class PSCalibrate : public QObject {
 
 		// processing
 		void init();
-		bool update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode);
+		bool update(cv::Mat *mTracking, PSRenderLayer *renderLayer, PSTrackingMode trackingMode);
 		void close();
 
 		// interval
@@ -9,15 +9,21 @@
 
 	// Qt
 	#include <QDebug>
-	#include <QMediaDevices>
-	#include <QCameraDevice>
-	#include <QRegExp>
 
 	// OpenCV
 	#include <opencv2/objdetect/aruco_detector.hpp>
 	#include <opencv2/aruco.hpp>
 
 	// App
+	#include "source/PSCameraSource.h"
+	#include "source/PSVideoSource.h"
+	#include "source/PSImageSequenceSource.h"
+	#include "source/PSSyntheticSource.h"
+	#include "source/PSGStreamerSource.h"
+	#include "source/PSCameraFormat.h"
+	#if defined(Q_OS_LINUX)
+		#include "source/PSV4L2Source.h"
+	#endif
 	#include "../../global/Settings.h"
 
 
@@ -31,14 +37,28 @@
 
 	PSCapture::PSCapture(QObject *parent)
 		: QObject(parent),
-		  capture(nullptr),
+		  source(nullptr),
 		  matTracking(nullptr),
-		  matRender(nullptr),
+		  renderLayer(nullptr),
+		  captureThread(nullptr),
+		  isCapturing(false),
+		  frameRing(nullptr),
+		  frameDecoder(nullptr),
+		  currentFrame(nullptr),
+		  frameTimestamp(0),
+		  markerTracker(nullptr),
+		  planeWarp(nullptr),
 		  renderMode(RenderMode::Camera)
 	{
 
 		// init properties
-		capture = new cv::VideoCapture();
+		frameRing = new PSFrameRing();
+		frameDecoder = new PSFrameDecoder();
+		frameDecoder->setPreviewScale(Settings::instance()->getInt("decode_scale", 1));
+		markerTracker = new PSMarkerTracker(markerId);
+		markerTracker->detectionInterval = Settings::instance()->getInt("marker_interval", 10);
+		planeWarp = new PSPlaneWarp();
+		planeResolution = Settings::instance()->getInt("plane_width", 960);
 		smoothingFactor = Settings::instance()->getFloat("smoothing", 0.8f);
 		scalingFactor = Settings::instance()->getFloat("scaling", 1.0f);
 		calibrationMode = Settings::instance()->getString("calibration_mode", "auto");
@@ -51,7 +71,13 @@
 
 	PSCapture::~PSCapture() {
 
-		delete capture;
+		stopCaptureThread();
+
+		delete source;
+		delete frameDecoder;
+		delete frameRing;
+		delete markerTracker;
+		delete planeWarp;
 	}
 
 
@@ -65,23 +91,61 @@
 
 	void PSCapture::init() {
 
-		openCamera();
-		setCameraProps();
+		stopCaptureThread();
+
+		openSource();
 		loadCameraCalibration();
+		markerTracker->reset();
+
+		startCaptureThread();
 	}
 
 
-	void PSCapture::update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode) {
+	void PSCapture::update(cv::Mat *mTracking, PSRenderLayer *layer, PSTrackingMode trackingMode) {
 
 		matTracking = mTracking;
-		matRender = mRender;
+		renderLayer = layer;
+
+		// newest frame from capture thread
+		PSFrame *frame = frameRing->waitForFrame(100);
+		if(!frame) { return; }
+		currentFrame = frame;
+		frameTimestamp = frame->timestamp;
+
+		// full resolution is only decoded if it is used, known uses decode on the pool while the marker is searched
+		bool needsImage = trackingMode == PSTrackingMode::Calibrate || renderMode == RenderMode::Camera || calibrationMode != "auto";
+		bool isRequested = frameDecoder->isRunning() && needsImage;
+		if(isRequested) { frameDecoder->decodeImage(frame); }
 
-		if(!capture->read(*matTracking)) { return; }
-		*matRender = matTracking->clone();
-		
 		if(trackingMode != PSTrackingMode::Calibrate) {
 			processImage();
-			findArucoMarker();
+			findArucoMarker(frame->preview, frame->previewScale);
+		}
+
+		// plane is warped from the full resolution image once the marker is found
+		if(frameDecoder->isRunning() && !isRequested && markerIds.size() > 0) {
+			frameDecoder->decodeImage(frame);
+			isRequested = true;
+		}
+
+		if(isRequested) { frameDecoder->waitForImage(frame); }
+
+		// raw yuv frames are only converted as a whole for calibration and the camera view
+		if(frame->pixelFormat != PSPixelFormat::BGR) {
+
+			if(trackingMode == PSTrackingMode::Calibrate || renderMode == RenderMode::Camera) { convertImage(frame); }
+
+			*matTracking = frame->isDecoded ? frame->image : cv::Mat();
+			if(matTracking->empty()) { renderLayer->clear(frame->luma.size()); }
+			else { renderLayer->setBase(*matTracking); }
+		}
+		else {
+			*matTracking = frame->isDecoded ? frame->image : cv::Mat();
+			if(matTracking->empty()) { renderLayer->clear(frame->preview.size() * frame->previewScale); }
+			else { renderLayer->setBase(*matTracking); }
+		}
+
+		if(trackingMode != PSTrackingMode::Calibrate) {
 			drawArucoMarker();
 		}
 
@@ -94,7 +158,135 @@
 
 	void PSCapture::close() {
 
-		capture->release();
+		stopCaptureThread();
+		if(source) { source->close(); }
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CAPTURE THREAD
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Camera frames are read on a dedicated thread, so slow detection frames never block the camera.
+	 * The processing loop always picks up the newest complete frame from the ring.
+	 */
+
+	void PSCapture::startCaptureThread() {
+
+		if(!source || !source->isOpened()) { return; }
+
+		// preallocate ring slots with the negotiated frame format
+		frameRing->allocate(source->getFrameSize(), CV_8UC3);
+
+		// compressed camera frames are decoded in parallel
+		int decodeThreads = Settings::instance()->getInt("decode_threads", 2);
+		if(source->isEncoded() && decodeThreads > 0) {
+			frameDecoder->start(frameRing, decodeThreads);
+		}
+
+		isCapturing = true;
+		captureThread = QThread::create([this]() { captureFrames(); });
+		captureThread->start(QThread::HighPriority);
+	}
+
+
+	void PSCapture::stopCaptureThread() {
+
+		if(!captureThread) { return; }
+
+		isCapturing = false;
+		captureThread->wait();
+
+		delete captureThread;
+		captureThread = nullptr;
+
+		frameDecoder->stop();
+	}
+
+
+	void PSCapture::captureFrames() {
+
+		std::vector<uchar> data;
+		int64 index = 0;
+
+		while(isCapturing) {
+			if(frameDecoder->isRunning()) { grabFrame(index++, data); }
+			else { readFrame(index++); }
+		}
+	}
+
+
+	/**
+	 * Decode on the capture thread, sources reuse the preallocated slot if the format matches.
+	 */
+
+	void PSCapture::readFrame(int64 index) {
+
+		PSFrame &frame = frameRing->writeSlot();
+		PSPixelFormat pixelFormat = source->getPixelFormat();
+		if(!source->read(pixelFormat == PSPixelFormat::BGR ? frame.image : frame.raw)) {
+			QThread::msleep(5);
+			return;
+		}
+
+		// marker search on the luma plane of raw yuv frames
+		frame.pixelFormat = pixelFormat;
+		if(pixelFormat != PSPixelFormat::BGR) {
+			splitPlanes(frame);
+			frame.preview = frame.luma;
+			frame.isDecoded = false;
+		}
+		else {
+			frame.preview = frame.image;
+			frame.isDecoded = true;
+		}
+
+		frame.previewScale = 1;
+		frame.index = index;
+		frame.timestamp = source->getTimestamp();
+
+		// fast replays process every recorded frame exactly once
+		if(!source->isLive() && source->getPacing() == PSFramePacing::Fast) {
+			while(isCapturing && !frameRing->waitForConsumer(100)) {}
+		}
+
+		frameRing->publish();
+	}
+
+
+	/**
+	 * Only grab the compressed frame, the decoder publishes it to the ring.
+	 */
+
+	void PSCapture::grabFrame(int64 index, std::vector<uchar> &data) {
+
+		if(!source->grab(data)) {
+			QThread::msleep(5);
+			return;
+		}
+
+		frameDecoder->submit(data, index, source->getTimestamp());
+	}
+
+
+	uint64_t PSCapture::getDroppedFrames() {
+
+		return frameRing->getOverwritten() + frameDecoder->getDropped();
+	}
+
+
+	/**
+	 * Monotonic capture time of the current frame in microseconds, see PSFrameSource::now().
+	 */
+
+	int64 PSCapture::getFrameTimestamp() {
+
+		return frameTimestamp;
 	}
 
 
@@ -114,39 +306,81 @@
 
 /*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//	ARUCO MARKER
+//	RAW YUV
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
 	/**
-	 * Corner refinement does not work well with compressed camera frames (only raw sensor data).
+	 * Luma and chroma planes of a raw frame. NV12 planes are headers on the raw buffer, packed 4:2:2
+	 * formats are split into a luma plane and an interleaved half width chroma plane.
 	 */
 
-	void PSCapture::findArucoMarker(int id) {
+	void PSCapture::splitPlanes(PSFrame &frame) {
+
+		cv::Mat &raw = frame.raw;
+
+		if(frame.pixelFormat == PSPixelFormat::NV12) {
+			int h = raw.rows * 2 / 3;
+			frame.luma = raw.rowRange(0, h);
+			frame.chroma = raw.rowRange(h, raw.rows).reshape(2);
+			return;
+		}
+
+		// YUYV: Y0 U Y1 V, UYVY: U Y0 V Y1
+		bool isYUYV = frame.pixelFormat == PSPixelFormat::YUYV;
+		cv::Mat quads = raw.reshape(4);
+		frame.luma.create(raw.size(), CV_8UC1);
+		frame.chroma.create(quads.size(), CV_8UC2);
+
+		cv::extractChannel(raw, frame.luma, isYUYV ? 0 : 1);
+		int fromTo[] = { isYUYV ? 1 : 0, 0, isYUYV ? 3 : 2, 1 };
+		cv::mixChannels(&quads, 1, &frame.chroma, 1, fromTo, 2);
+	}
+
+
+	void PSCapture::convertImage(PSFrame *frame) {
+
+		if(frame->isDecoded) { return; }
+
+		int code = cv::COLOR_YUV2BGR_NV12;
+		if(frame->pixelFormat == PSPixelFormat::YUYV) { code = cv::COLOR_YUV2BGR_YUYV; }
+		else if(frame->pixelFormat == PSPixelFormat::UYVY) { code = cv::COLOR_YUV2BGR_UYVY; }
+
+		cv::cvtColor(frame->raw, frame->image, code);
+		frame->isDecoded = true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	ARUCO MARKER
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
-		cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_ARUCO_ORIGINAL);
 
-		// aruco config		
-		cv::aruco::DetectorParameters detectorParams = cv::aruco::DetectorParameters();
-		detectorParams.useAruco3Detection = true;
+	/**
+	 * The image may be a downscaled preview, corners are mapped back to full resolution.
+	 */
 
-		// detect marker
-		std::vector<int> markers;
-		std::vector<std::vector<cv::Point2f>> corners;
-		cv::aruco::ArucoDetector detector(dictionary, detectorParams);
-		detector.detectMarkers(*matTracking, corners, markers);
+	void PSCapture::findArucoMarker(cv::Mat &image, int scale) {
 
-		// get only the selected marker
 		markerIds.clear();
 		markerCorners.clear();
-		for(size_t i = 0; i < markers.size(); ++i) {
-			if (markers[i] == id) {
-				markerIds.push_back(markers[i]);
-				markerCorners.push_back(corners[i]);
-				break;
+
+		std::vector<cv::Point2f> corners;
+		if(!markerTracker->update(image, corners)) { return; }
+
+		// preview pixel centers to full resolution
+		if(scale > 1) {
+			for(cv::Point2f &corner : corners) {
+				corner = (corner + cv::Point2f(0.5f, 0.5f)) * scale - cv::Point2f(0.5f, 0.5f);
 			}
 		}
+
+		markerIds.push_back(markerId);
+		markerCorners.push_back(corners);
 	}
 
 
@@ -154,7 +388,15 @@
 
 		if(markerIds.size() == 0) { return; }
 
-		cv::aruco::drawDetectedMarkers(*matRender, markerCorners, markerIds);
+		for(size_t i = 0; i < markerIds.size(); i++) {
+
+			// outline with highlighted first corner and id
+			std::vector<cv::Point2f> &corners = markerCorners[i];
+			cv::Point2f center = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+			renderLayer->drawPolygon(corners, cv::Scalar(0, 255, 0));
+			renderLayer->drawRect(cv::Rect(cv::Point(corners[0]) - cv::Point(3, 3), cv::Size(6, 6)), cv::Scalar(0, 0, 255));
+			renderLayer->drawText("id=" + std::to_string(markerIds[i]), center, 0.5, cv::Scalar(255, 0, 0), 2);
+		}
 	}
 
 
@@ -165,13 +407,21 @@
 		rvecs.clear();
 		tvecs.clear();
 
-		cv::aruco::estimatePoseSingleMarkers(markerCorners, markerSize, cameraMatrix, distCoeffs, rvecs, tvecs);
-		if(rvecs.size() == 0) { return; }
+		// previous pose is the initial guess while the marker stays locked
+		cv::Vec3d rvec, tvec;
+		if(!markerTracker->estimatePose(markerCorners[0], markerSize, cameraMatrix, distCoeffs, rvec, tvec)) { return; }
+		rvecs.push_back(rvec);
+		tvecs.push_back(tvec);
 		 
 		// draw axis
 		if(renderMode == RenderMode::Camera) {
+			std::vector<cv::Point3f> axes = { {0, 0, 0}, {0.02f, 0, 0}, {0, 0.02f, 0}, {0, 0, 0.02f} };
 			for(size_t i = 0; i < rvecs.size(); i++) {
-				cv::drawFrameAxes(*matRender, cameraMatrix, distCoeffs, rvecs[i], tvecs[i], 0.02f);
+				std::vector<cv::Point2f> points;
+				cv::projectPoints(axes, rvecs[i], tvecs[i], cameraMatrix, distCoeffs, points);
+				renderLayer->drawLine(points[0], points[1], cv::Scalar(0, 0, 255), 3);
+				renderLayer->drawLine(points[0], points[2], cv::Scalar(0, 255, 0), 3);
+				renderLayer->drawLine(points[0], points[3], cv::Scalar(255, 0, 0), 3);
 			}
 		}
 	}
@@ -212,29 +462,38 @@
 		}
 
 		// create plane mat from width and height
-		float w = 960;
-		float h = planeHeight * 960/planeWidth;
-
-		// 2d plane points
-		std::vector<cv::Point2f> plane;
-		plane.push_back(cv::Point2f(0, 0));
-		plane.push_back(cv::Point2f(w, 0));
-		plane.push_back(cv::Point2f(w, h));
-		plane.push_back(cv::Point2f(0, h));
+		float w = planeResolution;
+		float h = planeHeight * planeResolution/planeWidth;
 
-		// warp perspective
+		// undistort and warp perspective with cached remap tables
 		if(currentImagePoints.size() > 0) {
-			cv::Mat homography = cv::findHomography(currentImagePoints, plane);
-			cv::warpPerspective(*matTracking, *matTracking, homography, cv::Size(w,h));
+
+			// warp into a new buffer, the frame may be the base of the camera view
+			cv::Mat plane;
+			if(currentFrame->pixelFormat != PSPixelFormat::BGR) {
+				cv::Size planeSize((int) w & ~1, (int) h & ~1);
+				planeWarp->update(currentImagePoints, planeSize, currentFrame->luma.size());
+				planeWarp->warpPlanes(currentFrame->luma, currentFrame->chroma, plane);
+			}
+			else {
+				planeWarp->update(currentImagePoints, cv::Size(w,h), matTracking->size());
+				planeWarp->warp(*matTracking, plane);
+			}
+			*matTracking = plane;
+		}
+		else {
+			// unwarped copy, the white marker shape is drawn below
+			if(matTracking->empty()) { convertImage(currentFrame); }
+			*matTracking = currentFrame->image.clone();
 		}
 
 		// replace aruoco marker with white shape (add 20px border)
-		w = markerSize * 960/planeWidth + 40.0;
+		w = markerSize * planeResolution/planeWidth + 40.0;
 		h = markerSize * h/planeHeight + 40.0;
 		cv::rectangle(*matTracking, cv::Point(0,0), cv::Point(w,h), cv::Scalar(255,255,255), -1);
 
 		if(renderMode == RenderMode::PaperScope) {
-			*matRender = matTracking->clone();
+			renderLayer->setBase(*matTracking);
 		}
 	}
 
@@ -293,69 +552,57 @@
 
 /*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//	CAMERA
+//	SOURCE
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	void PSCapture::openCamera() {
+	/**
+	 * Create the frame source selected by capture_source. Recorded and synthetic sources make the pipeline
+	 * reproducible without a camera, capture_pacing switches between real-time replay and as fast as possible.
+	 */
 
-		QString selectedCamera = Settings::instance()->getString("cameraDevice");
-		int index = 0;
-
-		// get selected/saved camera
-		if(!selectedCamera.isEmpty()) {
-			QList<QCameraDevice> availableCameras = QMediaDevices::videoInputs();
-			for(int i = 0; i < availableCameras.size(); i++) {
-				if(availableCameras[i].description() == selectedCamera) { 
-					index = i;
-					break; 
-				}
-			}
-		}
+	void PSCapture::openSource() {
 
-		// open camera
-		#if defined(Q_OS_WIN)
-			capture->open(index, cv::CAP_DSHOW);
-			// capture->open(index + 1 + cv::CAP_DSHOW);
-		#elif defined(Q_OS_MAC)
-			capture->open(index);
-		#endif
-	}
+		delete source;
 
+		QString sourceType = Settings::instance()->getString("capture_source", "camera");
+		QString sourcePath = Settings::instance()->getString("capture_path");
 
-	/**
-	 * Set camera properties. Must be called after opening the camera.
-	 */
+		// create source
+		if(sourceType == "video") { source = new PSVideoSource(sourcePath.toStdString()); }
+		else if(sourceType == "images") { source = new PSImageSequenceSource(sourcePath); }
+		else if(sourceType == "synthetic") {
+			PSSyntheticSource *synthetic = new PSSyntheticSource();
+			synthetic->setPieceCount(Settings::instance()->getInt("synthetic_pieces", 0));
+			source = synthetic;
+		}
+		else if(sourceType == "gstreamer") { source = new PSGStreamerSource(sourcePath.toStdString()); }
+		else { source = createCameraSource(); }
 
-	void PSCapture::setCameraProps() {
+		// luma and chroma planes instead of bgr frames
+		source->setRawOutput(Settings::instance()->getBool("capture_raw_yuv", false));
 
-		QString selectedFormat = Settings::instance()->getString("cameraFormat");
+		// replay speed of recorded sources
+		QString pacing = Settings::instance()->getString("capture_pacing", "realtime");
+		source->setPacing(pacing == "fast" ? PSFramePacing::Fast : PSFramePacing::RealTime);
 
-		int width = 1280;
-		int height = 720;
-		int fps = 60;
-		std::string pixelFormat = "NV12";
+		if(!source->open()) { qDebug() << "could not open capture source" << sourceType << sourcePath; }
+	}
 
-		// parse saved format
-		QRegExp rx("(\\d+)x(\\d+) - (\\d+)fps \\((\\w+)\\)");
-		if(rx.indexIn(selectedFormat) != -1) {
-			width = rx.cap(1).toInt();
-			height = rx.cap(2).toInt();
-			fps = rx.cap(3).toInt();
-			pixelFormat = rx.cap(4).toStdString();
-		}
 
-		// set format
-		capture->set(cv::CAP_PROP_FRAME_WIDTH, width);
-		capture->set(cv::CAP_PROP_FRAME_HEIGHT, height);
-		capture->set(cv::CAP_PROP_FPS, fps);
-		capture->set(cv::CAP_PROP_AUTO_EXPOSURE, 0.75);
+	/**
+	 * Linux uses the native V4L2 backend, Windows and macOS open the camera through OpenCV.
+	 */
+
+	PSFrameSource* PSCapture::createCameraSource() {
 
-		#if defined(Q_OS_WIN)
-			capture->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M','J','P','G'));
-		#elif defined(Q_OS_MAC)
-			capture->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc(pixelFormat[0], pixelFormat[1], pixelFormat[2], pixelFormat[3]));
+		#if defined(Q_OS_LINUX)
+			QString selectedCamera = Settings::instance()->getString("cameraDevice");
+			PSCameraFormat format = PSCameraFormat::parse(Settings::instance()->getString("cameraFormat"));
+			return new PSV4L2Source(PSV4L2Source::findDevice(selectedCamera), format);
+		#else
+			return new PSCameraSource();
 		#endif
 	}
 
@@ -376,6 +623,7 @@
 		// make default camera calibration
 		cameraMatrix = Settings::instance()->getMat("cameraMatrix_"+selectedCamera,cv::Mat::eye(3, 3, CV_64F));
 		distCoeffs = Settings::instance()->getMat("distCoeffs_"+selectedCamera,cv::Mat::zeros(5, 1, CV_64F));
+		planeWarp->setCalibration(cameraMatrix, distCoeffs);
 	}
 
 
@@ -392,6 +640,9 @@
 		if(key == "cameraMatrix" || key == "distCoeffs") { 
 			loadCameraCalibration();
 		}
+		else if(key == "marker_interval") {
+			markerTracker->detectionInterval = value.toInt();
+		}
 		else if(key == "renderMode") {
 			renderMode = (RenderMode) value.toInt();
 		}
@@ -406,6 +657,12 @@
 			scalingFactor = value.toFloat();
 			updatePlaneSize();
 		}
+		else if(key == "plane_width") {
+			planeResolution = value.toInt();
+		}
+		else if(key == "decode_scale") {
+			frameDecoder->setPreviewScale(value.toInt());
+		}
 		else if(key == "calibration_mode") {
 			calibrationMode = value.toString();
 		}
@@ -7,13 +7,24 @@
 
 	#pragma once
 
+	// C++
+	#include <atomic>
+
 	// Qt
 	#include <QObject>
+	#include <QThread>
 
 	// OpenCV
 	#include <opencv2/opencv.hpp>
 
 	// App
+	#include "PSFrame.h"
+	#include "PSFrameRing.h"
+	#include "PSFrameDecoder.h"
+	#include "PSMarkerTracker.h"
+	#include "PSPlaneWarp.h"
+	#include "source/PSFrameSource.h"
+	#include "../PSRenderLayer.h"
 	#include "../PSTrackingMode.h"
 	#include "../../global/Settings.h"
 	#include "../../ui/renderer/RenderMode.h"
@@ -38,28 +49,51 @@ class PSCapture : public QObject {
 
 		// processing
 		void init();
-		void update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode);
+		void update(cv::Mat *mTracking, PSRenderLayer *layer, PSTrackingMode trackingMode);
 		void close();
 
 		// opencv
-		cv::VideoCapture *capture;	
+		PSFrameSource *source;
 		cv::Mat *matTracking;
-		cv::Mat *matRender;
+		PSRenderLayer *renderLayer;
 
 		// calibration
 		std::vector<cv::Point2f> manualImagePoints;
 		std::vector<cv::Point2f> currentImagePoints;
 
+		// stats
+		uint64_t getDroppedFrames();
+		int64 getFrameTimestamp();
+
 
 	private:
 
+		// capture thread
+		void startCaptureThread();
+		void stopCaptureThread();
+		void captureFrames();
+		void readFrame(int64 index);
+		void grabFrame(int64 index, std::vector<uchar> &data);
+		QThread *captureThread;
+		std::atomic<bool> isCapturing;
+		PSFrameRing *frameRing;
+		PSFrameDecoder *frameDecoder;
+		PSFrame *currentFrame;
+		int64 frameTimestamp;
+
 		// image processing
 		void processImage();
 
+		// raw yuv
+		void splitPlanes(PSFrame &frame);
+		void convertImage(PSFrame *frame);
+
 		// aruco marker
-		void findArucoMarker(int id = 16);
+		void findArucoMarker(cv::Mat &image, int scale = 1);
 		void drawArucoMarker();
 		void estimateMarkerPose();
+		static constexpr int markerId = 16;
+		PSMarkerTracker *markerTracker;
 		float markerPadding;
 		float markerSize;
 		std::vector<int> markerIds;
@@ -68,17 +102,21 @@ class PSCapture : public QObject {
 		// 2d plane
 		void get2DPlane();
 		void updatePlaneSize();
+		PSPlaneWarp *planeWarp;
 		float planeWidth;
 		float planeHeight;
+		int planeResolution;
 
 		// smoothing
 		void applySmoothing(std::vector<cv::Point2f> points);
 		float smoothingFactor;
 		float scalingFactor;
 
+		// source
+		void openSource();
+		PSFrameSource* createCameraSource();
+
 		// camera
-		void openCamera();
-		void setCameraProps();
 		cv::Mat cameraMatrix;
 		cv::Mat distCoeffs;
 		std::vector<cv::Vec3d> tvecs;
@@ -0,0 +1,57 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "source/PSPixelFormat.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Slot of the frame ring. Compressed camera frames keep their encoded data, so the full resolution image
+ * is only decoded when needed. The preview is used for the marker search and is either a DCT-scaled decode
+ * (1/previewScale of the image size) or a header on the image itself. Raw YUV frames keep luma and chroma
+ * planes, the marker search runs on the luma plane and the BGR image is only converted where it is needed.
+ */
+
+struct PSFrame {
+
+	// image
+	cv::Mat image;
+	bool isDecoded = false;
+
+	// marker search
+	cv::Mat preview;
+	int previewScale = 1;
+
+	// compressed data
+	std::vector<uchar> encoded;
+
+	// raw yuv data
+	PSPixelFormat pixelFormat = PSPixelFormat::BGR;
+	cv::Mat raw;
+	cv::Mat luma;
+	cv::Mat chroma;
+
+	// capture
+	int64 index = 0;
+	int64 timestamp = 0;
+};
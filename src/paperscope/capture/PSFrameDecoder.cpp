@@ -0,0 +1,297 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSFrameDecoder.h"
+
+	// C++
+	#include <algorithm>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSFrameDecoder::PSFrameDecoder()
+		: isStopping(false),
+		  imageRequest(nullptr),
+		  frameRing(nullptr),
+		  lastPublished(-1),
+		  previewScale(1),
+		  countDropped(0)
+	{
+
+	}
+
+
+	PSFrameDecoder::~PSFrameDecoder() {
+
+		stop();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	WORKERS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSFrameDecoder::start(PSFrameRing *ring, int threadCount) {
+
+		stop();
+
+		frameRing = ring;
+		lastPublished = -1;
+		countDropped = 0;
+
+		for(int i = 0; i < std::max(1, threadCount); i++) {
+			workers.emplace_back([this]() { decodeFrames(); });
+		}
+	}
+
+
+	void PSFrameDecoder::stop() {
+
+		if(workers.empty()) { return; }
+
+		// wake up all workers and a waiting processing thread
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			isStopping = true;
+		}
+		queueCondition.notify_all();
+		imageCondition.notify_all();
+
+		for(std::thread &worker : workers) { worker.join(); }
+		workers.clear();
+
+		packets.clear();
+		imageRequest = nullptr;
+		isStopping = false;
+	}
+
+
+	bool PSFrameDecoder::isRunning() {
+
+		return !workers.empty();
+	}
+
+
+	/**
+	 * Full resolution requests of the processing thread are served before new packets, they block the current frame.
+	 */
+
+	void PSFrameDecoder::decodeFrames() {
+
+		PSFrame frame;
+
+		while(true) {
+
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return isStopping || imageRequest || !packets.empty(); });
+			if(isStopping) { return; }
+
+			// full resolution image of the current frame
+			if(imageRequest) {
+
+				PSFrame *request = imageRequest;
+				imageRequest = nullptr;
+				lock.unlock();
+
+				cv::imdecode(request->encoded, cv::IMREAD_COLOR, &request->image);
+
+				lock.lock();
+				request->isDecoded = true;
+				imageCondition.notify_all();
+				continue;
+			}
+
+			// next packet
+			Packet packet = std::move(packets.front());
+			packets.pop_front();
+			lock.unlock();
+
+			decodePacket(packet, frame);
+			if(!frame.preview.empty()) { publish(frame); }
+
+			lock.lock();
+			recycle(packet.data);
+		}
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PACKETS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Called from the capture thread. The encoded data is swapped into the queue and data receives a recycled buffer.
+	 */
+
+	void PSFrameDecoder::submit(std::vector<uchar> &data, int64 index, int64 timestamp) {
+
+		std::lock_guard<std::mutex> lock(queueMutex);
+
+		// one pending packet per worker, older packets would be overwritten in the ring anyway
+		while(packets.size() >= workers.size()) {
+			recycle(packets.front().data);
+			packets.pop_front();
+			countDropped++;
+		}
+
+		Packet packet;
+		packet.data.swap(data);
+		packet.index = index;
+		packet.timestamp = timestamp;
+		packets.push_back(std::move(packet));
+
+		// hand a recycled buffer back to the capture thread
+		if(!freeBuffers.empty()) {
+			data.swap(freeBuffers.back());
+			freeBuffers.pop_back();
+		}
+
+		queueCondition.notify_one();
+	}
+
+
+	/**
+	 * Decode the preview only (1/2 or 1/4 DCT-scaled by libjpeg) or the full image with a preview header on it.
+	 */
+
+	void PSFrameDecoder::decodePacket(Packet &packet, PSFrame &frame) {
+
+		int scale = previewScale;
+
+		// frame keeps the encoded data, packet takes the old buffer for recycling
+		frame.encoded.swap(packet.data);
+		frame.index = packet.index;
+		frame.timestamp = packet.timestamp;
+		frame.previewScale = scale;
+
+		if(scale > 1) {
+			int flags = scale == 4 ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_COLOR_2;
+			cv::imdecode(frame.encoded, flags, &frame.preview);
+			frame.isDecoded = false;
+		}
+		else {
+			cv::imdecode(frame.encoded, cv::IMREAD_COLOR, &frame.image);
+			frame.preview = frame.image;
+			frame.isDecoded = true;
+		}
+	}
+
+
+	void PSFrameDecoder::recycle(std::vector<uchar> &data) {
+
+		if(freeBuffers.size() >= workers.size() + 2) { return; }
+
+		freeBuffers.emplace_back();
+		freeBuffers.back().swap(data);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FULL RESOLUTION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Start decoding the full resolution image of the acquired frame, so it runs while the marker is searched in the preview.
+	 */
+
+	void PSFrameDecoder::decodeImage(PSFrame *frame) {
+
+		if(frame->isDecoded) { return; }
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			imageRequest = frame;
+		}
+		queueCondition.notify_all();
+	}
+
+
+	void PSFrameDecoder::waitForImage(PSFrame *frame) {
+
+		std::unique_lock<std::mutex> lock(queueMutex);
+		imageCondition.wait(lock, [this, frame]() { return frame->isDecoded || isStopping; });
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PUBLISH
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Workers finish out of order, frames overtaken by a newer frame are dropped. The slot contents are swapped,
+	 * so the worker reuses the buffers of the slot it replaced.
+	 */
+
+	void PSFrameDecoder::publish(PSFrame &frame) {
+
+		std::lock_guard<std::mutex> lock(publishMutex);
+
+		if(frame.index <= lastPublished) {
+			countDropped++;
+			return;
+		}
+
+		lastPublished = frame.index;
+		std::swap(frame, frameRing->writeSlot());
+		frameRing->publish();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PREVIEW
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSFrameDecoder::setPreviewScale(int scale) {
+
+		previewScale = (scale == 2 || scale == 4) ? scale : 1;
+	}
+
+
+	int PSFrameDecoder::getPreviewScale() {
+
+		return previewScale;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	STATS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	uint64_t PSFrameDecoder::getDropped() {
+
+		return countDropped.load();
+	}
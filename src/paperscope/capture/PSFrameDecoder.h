@@ -0,0 +1,104 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <atomic>
+	#include <condition_variable>
+	#include <cstdint>
+	#include <deque>
+	#include <mutex>
+	#include <thread>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrame.h"
+	#include "PSFrameRing.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Small worker pool decoding compressed camera frames. The capture thread only grabs the encoded data,
+ * workers decode consecutive frames in parallel and publish them to the frame ring in capture order.
+ * With a preview scale of 2 or 4 only a DCT-scaled preview is decoded for the marker search, the full
+ * resolution image is decoded on request of the processing thread.
+ */
+
+class PSFrameDecoder {
+
+	public:
+
+		PSFrameDecoder();
+		~PSFrameDecoder();
+
+		// workers
+		void start(PSFrameRing *ring, int threadCount);
+		void stop();
+		bool isRunning();
+
+		// capture thread
+		void submit(std::vector<uchar> &data, int64 index, int64 timestamp);
+
+		// processing thread
+		void decodeImage(PSFrame *frame);
+		void waitForImage(PSFrame *frame);
+
+		// preview
+		void setPreviewScale(int scale);
+		int getPreviewScale();
+
+		// stats
+		uint64_t getDropped();
+
+
+	private:
+
+		// workers
+		void decodeFrames();
+		std::vector<std::thread> workers;
+		bool isStopping;
+
+		// packets
+		struct Packet {
+			std::vector<uchar> data;
+			int64 index = 0;
+			int64 timestamp = 0;
+		};
+		void decodePacket(Packet &packet, PSFrame &frame);
+		void recycle(std::vector<uchar> &data);
+		std::deque<Packet> packets;
+		std::vector<std::vector<uchar>> freeBuffers;
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+
+		// full resolution
+		PSFrame *imageRequest;
+		std::condition_variable imageCondition;
+
+		// publish
+		void publish(PSFrame &frame);
+		PSFrameRing *frameRing;
+		std::mutex publishMutex;
+		int64 lastPublished;
+
+		// preview
+		std::atomic<int> previewScale;
+
+		// stats
+		std::atomic<uint64_t> countDropped;
+};
@@ -0,0 +1,168 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSFrameRing.h"
+
+	// C++
+	#include <thread>
+	#include <chrono>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSFrameRing::PSFrameRing()
+		: writeIndex(0),
+		  readIndex(1),
+		  latestIndex(2),
+		  countPublished(0),
+		  countOverwritten(0)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SLOTS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Preallocate all slots with the camera frame format. Only call while no producer is running.
+	 */
+
+	void PSFrameRing::allocate(cv::Size size, int type) {
+
+		for(int i = 0; i < SLOT_COUNT; i++) {
+			frameSlots[i].image.create(size, type);
+			frameSlots[i].isDecoded = false;
+		}
+
+		reset();
+	}
+
+
+	void PSFrameRing::reset() {
+
+		writeIndex = 0;
+		readIndex = 1;
+		latestIndex.store(2);
+
+		countPublished = 0;
+		countOverwritten = 0;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PRODUCER
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSFrame& PSFrameRing::writeSlot() {
+
+		return frameSlots[writeIndex];
+	}
+
+
+	void PSFrameRing::publish() {
+
+		// swap written slot with latest slot and mark it as new
+		int previous = latestIndex.exchange(writeIndex | SLOT_DIRTY, std::memory_order_acq_rel);
+		writeIndex = previous & SLOT_MASK;
+
+		// previous frame was never picked up by the consumer
+		if(previous & SLOT_DIRTY) { countOverwritten++; }
+		countPublished++;
+	}
+
+
+	/**
+	 * Wait until the consumer took the latest published frame, the next publish() does not overwrite it.
+	 * Returns false on timeout.
+	 */
+
+	bool PSFrameRing::waitForConsumer(int timeout) {
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+		while(latestIndex.load(std::memory_order_acquire) & SLOT_DIRTY) {
+			if(std::chrono::steady_clock::now() > deadline) { return false; }
+			std::this_thread::sleep_for(std::chrono::microseconds(250));
+		}
+
+		return true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSUMER
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Take the newest complete frame. The returned slot is owned by the consumer until the next acquire.
+	 */
+
+	PSFrame* PSFrameRing::acquire() {
+
+		if(!(latestIndex.load(std::memory_order_acquire) & SLOT_DIRTY)) { return nullptr; }
+
+		// swap read slot with latest slot
+		int previous = latestIndex.exchange(readIndex, std::memory_order_acq_rel);
+		readIndex = previous & SLOT_MASK;
+
+		return &frameSlots[readIndex];
+	}
+
+
+	PSFrame* PSFrameRing::waitForFrame(int timeout) {
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+		PSFrame *frame = acquire();
+		while(!frame) {
+			if(std::chrono::steady_clock::now() > deadline) { return nullptr; }
+			std::this_thread::sleep_for(std::chrono::microseconds(250));
+			frame = acquire();
+		}
+
+		return frame;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	STATS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	uint64_t PSFrameRing::getPublished() {
+
+		return countPublished.load();
+	}
+
+
+	uint64_t PSFrameRing::getOverwritten() {
+
+		return countOverwritten.load();
+	}
@@ -0,0 +1,72 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <atomic>
+	#include <cstdint>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrame.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Lock-free single-producer/single-consumer ring of preallocated frames. The producer always owns one slot,
+ * the consumer owns one slot and the third slot holds the latest published frame.
+ */
+
+class PSFrameRing {
+
+	public:
+
+		PSFrameRing();
+
+		// slots
+		void allocate(cv::Size size, int type);
+		void reset();
+
+		// producer
+		PSFrame& writeSlot();
+		void publish();
+		bool waitForConsumer(int timeout);
+
+		// consumer
+		PSFrame* acquire();
+		PSFrame* waitForFrame(int timeout);
+
+		// stats
+		uint64_t getPublished();
+		uint64_t getOverwritten();
+
+
+	private:
+
+		// slots
+		static const int SLOT_COUNT = 3;
+		static const int SLOT_MASK = 0x3;
+		static const int SLOT_DIRTY = 0x4;
+		PSFrame frameSlots[SLOT_COUNT];
+		int writeIndex;
+		int readIndex;
+		std::atomic<int> latestIndex;
+
+		// stats
+		std::atomic<uint64_t> countPublished;
+		std::atomic<uint64_t> countOverwritten;
+};
@@ -0,0 +1,260 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSMarkerTracker.h"
+
+	// App
+	#include "../PSProfiler.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSMarkerTracker::PSMarkerTracker(int markerId)
+		: detectionInterval(10),
+		  detector(nullptr),
+		  markerId(markerId),
+		  framesSinceDetection(0),
+		  isLocked(false),
+		  hasPose(false)
+	{
+
+		cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_ARUCO_ORIGINAL);
+
+		// aruco config, corner refinement does not work well with compressed camera frames
+		cv::aruco::DetectorParameters detectorParams = cv::aruco::DetectorParameters();
+		detectorParams.useAruco3Detection = true;
+
+		detector = new cv::aruco::ArucoDetector(dictionary, detectorParams);
+	}
+
+
+	PSMarkerTracker::~PSMarkerTracker() {
+
+		delete detector;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TRACKING
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Find the marker corners in image (BGR or single channel luma). Returns false if the marker is lost.
+	 */
+
+	bool PSMarkerTracker::update(cv::Mat &image, std::vector<cv::Point2f> &corners) {
+
+		if(image.channels() == 1) { gray = image; }
+		else { cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY); }
+
+		// image size changed (e.g. other preview scale)
+		if(!previousPyramid.empty() && previousPyramid[0].size() != gray.size()) { reset(); }
+
+		PSProfiler *profiler = PSProfiler::instance();
+		bool found = false;
+		bool hasPyramid = false;
+
+		// follow the corners between detections
+		if(isLocked && framesSinceDetection < detectionInterval) {
+			found = trackCorners(gray, corners);
+			hasPyramid = true;
+			if(found) { profiler->count("marker tracked"); }
+		}
+
+		// search the predicted region first, then the whole frame
+		if(!found && isLocked) {
+			found = detectMarker(gray, predictRoi(gray.size()), corners);
+			if(found) { profiler->count("marker roi"); }
+		}
+		if(!found) {
+			found = detectMarker(gray, cv::Rect(0, 0, gray.cols, gray.rows), corners);
+			profiler->count("marker full");
+		}
+
+		if(!found) {
+			reset();
+			return false;
+		}
+
+		// keep pyramid for optical flow of the next frame
+		if(!hasPyramid) { buildPyramid(gray, pyramid); }
+		std::swap(previousPyramid, pyramid);
+
+		previousCorners = corners;
+		isLocked = true;
+
+		return true;
+	}
+
+
+	void PSMarkerTracker::reset() {
+
+		isLocked = false;
+		hasPose = false;
+		framesSinceDetection = 0;
+		previousCorners.clear();
+		previousPyramid.clear();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	DETECTION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSMarkerTracker::detectMarker(cv::Mat &gray, cv::Rect roi, std::vector<cv::Point2f> &corners) {
+
+		std::vector<int> markers;
+		std::vector<std::vector<cv::Point2f>> detected;
+		detector->detectMarkers(gray(roi), detected, markers);
+
+		// get only the selected marker
+		for(size_t i = 0; i < markers.size(); ++i) {
+			if(markers[i] == markerId) {
+
+				corners = detected[i];
+				for(cv::Point2f &corner : corners) { corner += cv::Point2f(roi.x, roi.y); }
+
+				framesSinceDetection = 0;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+
+	/**
+	 * Bounding box of the last corners, grown by the marker size in every direction.
+	 */
+
+	cv::Rect PSMarkerTracker::predictRoi(cv::Size size) {
+
+		cv::Rect box = cv::boundingRect(previousCorners);
+		int margin = std::max(box.width, box.height);
+
+		cv::Rect roi(box.x - margin, box.y - margin, box.width + margin * 2, box.height + margin * 2);
+		return roi & cv::Rect(0, 0, size.width, size.height);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	OPTICAL FLOW
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Pyramidal Lucas-Kanade with forward-backward check. Tracking fails if a corner is lost, drifts
+	 * more than one pixel between the forward and backward pass or the marker shape changes too much.
+	 */
+
+	bool PSMarkerTracker::trackCorners(cv::Mat &gray, std::vector<cv::Point2f> &corners) {
+
+		buildPyramid(gray, pyramid);
+
+		std::vector<cv::Point2f> backward;
+		std::vector<uchar> status, statusBackward;
+		std::vector<float> error;
+		cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 0.03);
+
+		cv::calcOpticalFlowPyrLK(previousPyramid, pyramid, previousCorners, corners, status, error, cv::Size(21, 21), 3, criteria);
+		cv::calcOpticalFlowPyrLK(pyramid, previousPyramid, corners, backward, statusBackward, error, cv::Size(21, 21), 3, criteria);
+
+		for(size_t i = 0; i < corners.size(); i++) {
+			if(!status[i] || !statusBackward[i]) { return false; }
+			if(cv::norm(backward[i] - previousCorners[i]) > 1.0) { return false; }
+		}
+
+		if(!isPlausible(corners)) { return false; }
+
+		framesSinceDetection++;
+		return true;
+	}
+
+
+	/**
+	 * Pyramid levels are always copied, the input may point into a frame ring slot that is reused by the capture thread.
+	 */
+
+	void PSMarkerTracker::buildPyramid(cv::Mat &gray, std::vector<cv::Mat> &levels) {
+
+		cv::buildOpticalFlowPyramid(gray, levels, cv::Size(21, 21), 3, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+	}
+
+
+	/**
+	 * Tracked corners must still form a convex quad of similar size.
+	 */
+
+	bool PSMarkerTracker::isPlausible(std::vector<cv::Point2f> &corners) {
+
+		if(!cv::isContourConvex(corners)) { return false; }
+
+		double area = cv::contourArea(corners);
+		double previousArea = cv::contourArea(previousCorners);
+		if(previousArea <= 0) { return false; }
+
+		double ratio = area / previousArea;
+		return ratio > 0.8 && ratio < 1.25;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	POSE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Same corner layout as estimatePoseSingleMarkers. While the marker stays locked the previous pose is
+	 * used as initial guess, so the iterative solver converges within a few iterations.
+	 */
+
+	bool PSMarkerTracker::estimatePose(std::vector<cv::Point2f> &corners, float markerSize, cv::Mat cameraMatrix, cv::Mat distCoeffs, cv::Vec3d &rvec, cv::Vec3d &tvec) {
+
+		float half = markerSize * 0.5f;
+		std::vector<cv::Point3f> objectPoints = {
+			cv::Point3f(-half, half, 0),
+			cv::Point3f(half, half, 0),
+			cv::Point3f(half, -half, 0),
+			cv::Point3f(-half, -half, 0)
+		};
+
+		bool success;
+		if(hasPose) {
+			rvec = previousRvec;
+			tvec = previousTvec;
+			success = cv::solvePnP(objectPoints, corners, cameraMatrix, distCoeffs, rvec, tvec, true, cv::SOLVEPNP_ITERATIVE);
+		}
+		else {
+			success = cv::solvePnP(objectPoints, corners, cameraMatrix, distCoeffs, rvec, tvec, false, cv::SOLVEPNP_IPPE_SQUARE);
+		}
+
+		hasPose = success;
+		previousRvec = rvec;
+		previousTvec = tvec;
+
+		return success;
+	}
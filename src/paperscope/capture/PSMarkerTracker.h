@@ -0,0 +1,74 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+	#include <opencv2/objdetect/aruco_detector.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Keeps track of a single ArUco marker over consecutive frames. The detector is created once, after the
+ * first lock the marker corners are followed with pyramidal optical flow and re-detected every
+ * detectionInterval frames inside a predicted region around the last corners. The whole frame is only
+ * searched again when tracking or the region search fails.
+ */
+
+class PSMarkerTracker {
+
+	public:
+
+		PSMarkerTracker(int markerId = 16);
+		~PSMarkerTracker();
+
+		// tracking
+		bool update(cv::Mat &image, std::vector<cv::Point2f> &corners);
+		void reset();
+		int detectionInterval;
+
+		// pose
+		bool estimatePose(std::vector<cv::Point2f> &corners, float markerSize, cv::Mat cameraMatrix, cv::Mat distCoeffs, cv::Vec3d &rvec, cv::Vec3d &tvec);
+
+
+	private:
+
+		// detection
+		bool detectMarker(cv::Mat &gray, cv::Rect roi, std::vector<cv::Point2f> &corners);
+		cv::Rect predictRoi(cv::Size size);
+		cv::aruco::ArucoDetector *detector;
+		int markerId;
+
+		// optical flow
+		bool trackCorners(cv::Mat &gray, std::vector<cv::Point2f> &corners);
+		bool isPlausible(std::vector<cv::Point2f> &corners);
+		void buildPyramid(cv::Mat &gray, std::vector<cv::Mat> &levels);
+		std::vector<cv::Mat> previousPyramid;
+		std::vector<cv::Point2f> previousCorners;
+		int framesSinceDetection;
+		bool isLocked;
+
+		// pose
+		cv::Vec3d previousRvec;
+		cv::Vec3d previousTvec;
+		bool hasPose;
+
+		// buffers
+		cv::Mat gray;
+		std::vector<cv::Mat> pyramid;
+};
@@ -0,0 +1,159 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSPlaneWarp.h"
+
+	// App
+	#include "../PSProfiler.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSPlaneWarp::PSPlaneWarp()
+		: tolerance(0.1f),
+		  isDirty(true)
+	{
+
+		cameraMatrix = cv::Mat::eye(3, 3, CV_64F);
+		distCoeffs = cv::Mat::zeros(5, 1, CV_64F);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CALIBRATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSPlaneWarp::setCalibration(cv::Mat newCameraMatrix, cv::Mat newDistCoeffs) {
+
+		newCameraMatrix.convertTo(cameraMatrix, CV_64F);
+		newDistCoeffs.convertTo(distCoeffs, CV_64F);
+
+		invalidate();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	MAPS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Corners are in distorted image coordinates (projected marker pose or manual calibration points).
+	 * Returns true if the maps were rebuilt.
+	 */
+
+	bool PSPlaneWarp::update(std::vector<cv::Point2f> &corners, cv::Size planeSize, cv::Size imageSize) {
+
+		if(!isDirty && planeSize == mapPlaneSize && imageSize == mapImageSize && !hasMoved(corners)) { return false; }
+
+		// homography from undistorted image pixels to the plane
+		std::vector<cv::Point2f> undistorted;
+		cv::undistortPoints(corners, undistorted, cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix);
+
+		std::vector<cv::Point2f> plane;
+		plane.push_back(cv::Point2f(0, 0));
+		plane.push_back(cv::Point2f(planeSize.width, 0));
+		plane.push_back(cv::Point2f(planeSize.width, planeSize.height));
+		plane.push_back(cv::Point2f(0, planeSize.height));
+		homography = cv::getPerspectiveTransform(undistorted, plane);
+
+		buildMaps(imageMap1, imageMap2, planeSize, cv::Matx33d::eye(), cv::Matx33d::eye());
+
+		mapCorners = corners;
+		mapPlaneSize = planeSize;
+		mapImageSize = imageSize;
+		chromaSize = cv::Size();
+		isDirty = false;
+
+		PSProfiler::instance()->count("plane maps rebuilt");
+		return true;
+	}
+
+
+	void PSPlaneWarp::invalidate() {
+
+		isDirty = true;
+	}
+
+
+	bool PSPlaneWarp::hasMoved(std::vector<cv::Point2f> &corners) {
+
+		if(corners.size() != mapCorners.size()) { return true; }
+
+		for(size_t i = 0; i < corners.size(); i++) {
+			if(cv::norm(corners[i] - mapCorners[i]) > tolerance) { return true; }
+		}
+
+		return false;
+	}
+
+
+	/**
+	 * initUndistortRectifyMap maps every plane pixel p to (newCameraMatrix)^-1 * p, distorts the result and
+	 * projects it with the camera matrix. Passing homography * cameraMatrix as new camera matrix fuses both
+	 * steps. imageScale and planeScale map to subsampled planes (e.g. chroma of raw yuv frames).
+	 */
+
+	void PSPlaneWarp::buildMaps(cv::Mat &maps1, cv::Mat &maps2, cv::Size size, cv::Matx33d imageScale, cv::Matx33d planeScale) {
+
+		cv::Matx33d camera = cameraMatrix;
+		cv::Mat sourceCamera = cv::Mat(imageScale * camera);
+		cv::Mat planeCamera = cv::Mat(planeScale * homography * camera);
+
+		cv::initUndistortRectifyMap(sourceCamera, distCoeffs, cv::noArray(), planeCamera, size, CV_16SC2, maps1, maps2);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	WARP
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSPlaneWarp::warp(cv::Mat &image, cv::Mat &plane) {
+
+		cv::remap(image, plane, imageMap1, imageMap2, cv::INTER_LINEAR);
+	}
+
+
+	/**
+	 * Remap luma and chroma separately and convert only the plane to BGR. The chroma maps are built on first
+	 * use, the warped chroma is written in NV12 layout (half width and height).
+	 */
+
+	void PSPlaneWarp::warpPlanes(cv::Mat &luma, cv::Mat &chroma, cv::Mat &plane) {
+
+		if(chromaSize != chroma.size()) {
+			double sx = (double) chroma.cols / luma.cols;
+			double sy = (double) chroma.rows / luma.rows;
+			cv::Matx33d imageScale(sx, 0, 0, 0, sy, 0, 0, 0, 1);
+			cv::Matx33d planeScale(0.5, 0, 0, 0, 0.5, 0, 0, 0, 1);
+			buildMaps(chromaMap1, chromaMap2, mapPlaneSize / 2, imageScale, planeScale);
+			chromaSize = chroma.size();
+		}
+
+		cv::remap(luma, warpedLuma, imageMap1, imageMap2, cv::INTER_LINEAR);
+
+		// neutral chroma outside of the frame
+		cv::remap(chroma, warpedChroma, chromaMap1, chromaMap2, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(128, 128));
+		cv::cvtColorTwoPlane(warpedLuma, warpedChroma, plane, cv::COLOR_YUV2BGR_NV12);
+	}
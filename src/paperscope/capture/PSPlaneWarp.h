@@ -0,0 +1,75 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Remap tables from the camera image to the 2D plane. Lens undistortion and the perspective warp are fused
+ * into a single lookup, the tables are only rebuilt when the plane corners move more than tolerance pixels,
+ * the plane size or the camera calibration changes.
+ */
+
+class PSPlaneWarp {
+
+	public:
+
+		PSPlaneWarp();
+
+		// calibration
+		void setCalibration(cv::Mat cameraMatrix, cv::Mat distCoeffs);
+
+		// maps
+		bool update(std::vector<cv::Point2f> &corners, cv::Size planeSize, cv::Size imageSize);
+		void invalidate();
+		float tolerance;
+
+		// warp
+		void warp(cv::Mat &image, cv::Mat &plane);
+		void warpPlanes(cv::Mat &luma, cv::Mat &chroma, cv::Mat &plane);
+
+
+	private:
+
+		// maps
+		bool hasMoved(std::vector<cv::Point2f> &corners);
+		void buildMaps(cv::Mat &maps1, cv::Mat &maps2, cv::Size size, cv::Matx33d imageScale, cv::Matx33d planeScale);
+		cv::Mat imageMap1;
+		cv::Mat imageMap2;
+		cv::Mat chromaMap1;
+		cv::Mat chromaMap2;
+		cv::Size chromaSize;
+		bool isDirty;
+
+		// geometry
+		std::vector<cv::Point2f> mapCorners;
+		cv::Size mapPlaneSize;
+		cv::Size mapImageSize;
+		cv::Matx33d homography;
+
+		// calibration
+		cv::Mat cameraMatrix;
+		cv::Mat distCoeffs;
+
+		// buffers
+		cv::Mat warpedLuma;
+		cv::Mat warpedChroma;
+};
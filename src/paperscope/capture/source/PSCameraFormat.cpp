@@ -0,0 +1,36 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSCameraFormat.h"
+
+	// Qt
+	#include <QRegExp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PARSE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSCameraFormat PSCameraFormat::parse(QString format) {
+
+		PSCameraFormat cameraFormat;
+
+		// parse saved format
+		QRegExp rx("(\\d+)x(\\d+) - (\\d+)fps \\((\\w+)\\)");
+		if(rx.indexIn(format) != -1) {
+			cameraFormat.width = rx.cap(1).toInt();
+			cameraFormat.height = rx.cap(2).toInt();
+			cameraFormat.fps = rx.cap(3).toInt();
+			cameraFormat.pixelFormat = rx.cap(4).toStdString();
+		}
+
+		return cameraFormat;
+	}
@@ -0,0 +1,37 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <string>
+
+	// Qt
+	#include <QString>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Camera format as saved in the cameraFormat setting, e.g. "1280x720 - 60fps (NV12)".
+ */
+
+struct PSCameraFormat {
+
+	int width = 1280;
+	int height = 720;
+	int fps = 60;
+	std::string pixelFormat = "NV12";
+
+	static PSCameraFormat parse(QString format);
+};
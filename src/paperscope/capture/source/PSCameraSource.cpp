@@ -0,0 +1,215 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSCameraSource.h"
+
+	// Qt
+	#include <QMediaDevices>
+	#include <QCameraDevice>
+
+	// App
+	#include "PSCameraFormat.h"
+	#include "../../../global/Settings.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSCameraSource::PSCameraSource()
+		: PSFrameSource(),
+		  capture(nullptr),
+		  encoded(false),
+		  yuv(false)
+	{
+
+		capture = new cv::VideoCapture();
+	}
+
+
+	PSCameraSource::~PSCameraSource() {
+
+		delete capture;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSCameraSource::open() {
+
+		openCamera();
+		setCameraProps();
+
+		return capture->isOpened();
+	}
+
+
+	void PSCameraSource::close() {
+
+		capture->release();
+	}
+
+
+	bool PSCameraSource::isOpened() {
+
+		return capture->isOpened();
+	}
+
+
+	bool PSCameraSource::isLive() {
+
+		return true;
+	}
+
+
+	bool PSCameraSource::isEncoded() {
+
+		return encoded;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSCameraSource::getFrameSize() {
+
+		return cv::Size((int) capture->get(cv::CAP_PROP_FRAME_WIDTH), (int) capture->get(cv::CAP_PROP_FRAME_HEIGHT));
+	}
+
+
+	double PSCameraSource::getFps() {
+
+		return capture->get(cv::CAP_PROP_FPS);
+	}
+
+
+	/**
+	 * AVFoundation delivers '2vuy' buffers in its YUYV mode, which is UYVY byte order.
+	 */
+
+	PSPixelFormat PSCameraSource::getPixelFormat() {
+
+		return yuv ? PSPixelFormat::UYVY : PSPixelFormat::BGR;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSCameraSource::readFrame(cv::Mat &frame) {
+
+		return capture->read(frame);
+	}
+
+
+	/**
+	 * Grab and retrieve are split, with CAP_PROP_CONVERT_RGB disabled retrieve returns the undecoded MJPEG buffer.
+	 */
+
+	bool PSCameraSource::grabFrame(std::vector<uchar> &data) {
+
+		if(!capture->grab() || !capture->retrieve(rawFrame) || rawFrame.empty()) { return false; }
+
+		data.assign(rawFrame.data, rawFrame.data + rawFrame.total() * rawFrame.elemSize());
+		return true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CAMERA
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSCameraSource::openCamera() {
+
+		QString selectedCamera = Settings::instance()->getString("cameraDevice");
+		int index = 0;
+
+		// get selected/saved camera
+		if(!selectedCamera.isEmpty()) {
+			QList<QCameraDevice> availableCameras = QMediaDevices::videoInputs();
+			for(int i = 0; i < availableCameras.size(); i++) {
+				if(availableCameras[i].description() == selectedCamera) {
+					index = i;
+					break;
+				}
+			}
+		}
+
+		// open camera
+		#if defined(Q_OS_WIN)
+			capture->open(index, cv::CAP_DSHOW);
+			// capture->open(index + 1 + cv::CAP_DSHOW);
+		#elif defined(Q_OS_MAC)
+			capture->open(index);
+		#elif defined(Q_OS_LINUX)
+			capture->open(index, cv::CAP_V4L2);
+		#endif
+	}
+
+
+	/**
+	 * Set camera properties. Must be called after opening the camera.
+	 */
+
+	void PSCameraSource::setCameraProps() {
+
+		PSCameraFormat format = PSCameraFormat::parse(Settings::instance()->getString("cameraFormat"));
+		std::string pixelFormat = format.pixelFormat;
+
+		// set format
+		capture->set(cv::CAP_PROP_FRAME_WIDTH, format.width);
+		capture->set(cv::CAP_PROP_FRAME_HEIGHT, format.height);
+		capture->set(cv::CAP_PROP_FPS, format.fps);
+		capture->set(cv::CAP_PROP_AUTO_EXPOSURE, 0.75);
+
+		#if defined(Q_OS_WIN)
+			capture->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M','J','P','G'));
+			pixelFormat = "MJPG";
+		#elif defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+			capture->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc(pixelFormat[0], pixelFormat[1], pixelFormat[2], pixelFormat[3]));
+		#endif
+
+		// hand out compressed frames to the decode pool if the backend supports raw MJPEG
+		encoded = false;
+		if(pixelFormat == "MJPG" && Settings::instance()->getInt("decode_threads", 2) > 0) {
+			encoded = capture->set(cv::CAP_PROP_CONVERT_RGB, 0) && capture->get(cv::CAP_PROP_CONVERT_RGB) == 0;
+			if(!encoded) { capture->set(cv::CAP_PROP_CONVERT_RGB, 1); }
+		}
+
+		// raw yuv frames (CV_CAP_MODE_YUYV of the AVFoundation backend)
+		yuv = false;
+		#if defined(Q_OS_MAC)
+			const int modeYUYV = 3;
+			if(rawOutput && pixelFormat != "MJPG") {
+				yuv = capture->set(cv::CAP_PROP_MODE, modeYUYV) && capture->get(cv::CAP_PROP_MODE) == modeYUYV;
+			}
+		#endif
+	}
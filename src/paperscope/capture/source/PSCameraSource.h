@@ -0,0 +1,61 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+class PSCameraSource : public PSFrameSource {
+
+	public:
+
+		PSCameraSource();
+		~PSCameraSource();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+		bool isLive() override;
+		bool isEncoded() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+		PSPixelFormat getPixelFormat() override;
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+		bool grabFrame(std::vector<uchar> &data) override;
+
+
+	private:
+
+		// camera
+		void openCamera();
+		void setCameraProps();
+		cv::VideoCapture *capture;
+		cv::Mat rawFrame;
+		bool encoded;
+		bool yuv;
+};
@@ -0,0 +1,188 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSFrameSource.h"
+
+	// C++
+	#include <thread>
+	#include <chrono>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSFrameSource::PSFrameSource()
+		: frameIndex(0),
+		  frameTimestamp(0),
+		  rawOutput(false),
+		  pacing(PSFramePacing::RealTime),
+		  frameTick(0)
+	{
+
+	}
+
+
+	PSFrameSource::~PSFrameSource() {
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSFrameSource::isLive() {
+
+		return false;
+	}
+
+
+	bool PSFrameSource::isEncoded() {
+
+		return false;
+	}
+
+
+	bool PSFrameSource::read(cv::Mat &frame) {
+
+		frameTimestamp = 0;
+		if(!readFrame(frame)) { return false; }
+
+		waitForNextFrame();
+		if(frameTimestamp == 0) { frameTimestamp = now(); }
+		frameIndex++;
+
+		return true;
+	}
+
+
+	/**
+	 * Same as read() without decoding. Only available if isEncoded() returns true.
+	 */
+
+	bool PSFrameSource::grab(std::vector<uchar> &data) {
+
+		frameTimestamp = 0;
+		if(!grabFrame(data)) { return false; }
+
+		waitForNextFrame();
+		if(frameTimestamp == 0) { frameTimestamp = now(); }
+		frameIndex++;
+
+		return true;
+	}
+
+
+	bool PSFrameSource::grabFrame(std::vector<uchar> &data) {
+
+		return false;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	double PSFrameSource::getFps() {
+
+		return 30.0;
+	}
+
+
+	PSPixelFormat PSFrameSource::getPixelFormat() {
+
+		return PSPixelFormat::BGR;
+	}
+
+
+	/**
+	 * Request raw YUV frames instead of BGR. Must be set before open(), sources without YUV support ignore it.
+	 */
+
+	void PSFrameSource::setRawOutput(bool enabled) {
+
+		rawOutput = enabled;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TIMESTAMPS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	int64 PSFrameSource::getTimestamp() {
+
+		return frameTimestamp;
+	}
+
+
+	/**
+	 * Monotonic clock in microseconds. Same clock as CLOCK_MONOTONIC driver timestamps on Linux.
+	 */
+
+	int64 PSFrameSource::now() {
+
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PACING
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSFrameSource::setPacing(PSFramePacing newPacing) {
+
+		pacing = newPacing;
+	}
+
+
+	PSFramePacing PSFrameSource::getPacing() {
+
+		return pacing;
+	}
+
+
+	/**
+	 * Hold back recorded frames until their capture time is reached. Fast mode delivers frames as soon as they are read.
+	 */
+
+	void PSFrameSource::waitForNextFrame() {
+
+		if(pacing == PSFramePacing::Fast || isLive()) { return; }
+
+		double fps = getFps();
+		int64 period = (int64) (cv::getTickFrequency() / (fps > 0 ? fps : 30.0));
+		int64 tick = cv::getTickCount();
+
+		// wait remaining time of the current frame
+		if(frameTick > 0 && tick - frameTick < period) {
+			int64 remaining = (period - (tick - frameTick)) * 1000000 / (int64) cv::getTickFrequency();
+			std::this_thread::sleep_for(std::chrono::microseconds(remaining));
+		}
+
+		frameTick = cv::getTickCount();
+	}
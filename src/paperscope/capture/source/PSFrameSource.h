@@ -0,0 +1,83 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFramePacing.h"
+	#include "PSPixelFormat.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Base class for everything PSCapture can read frames from. Recorded sources are paced by the base class,
+ * live sources deliver frames at their own rate. Timestamps are monotonic microseconds, sources with driver
+ * timestamps set frameTimestamp in readFrame(), all others are stamped when the frame is read.
+ * Encoded sources can also hand out the compressed camera data with grab(), decoding is left to the caller.
+ * With raw output enabled, YUV cameras deliver frames in the format reported by getPixelFormat().
+ */
+
+class PSFrameSource {
+
+	public:
+
+		PSFrameSource();
+		virtual ~PSFrameSource();
+
+		// source
+		virtual bool open() = 0;
+		virtual void close() = 0;
+		virtual bool isOpened() = 0;
+		virtual bool isLive();
+		virtual bool isEncoded();
+		bool read(cv::Mat &frame);
+		bool grab(std::vector<uchar> &data);
+
+		// format
+		virtual cv::Size getFrameSize() = 0;
+		virtual double getFps();
+		virtual PSPixelFormat getPixelFormat();
+		void setRawOutput(bool enabled);
+
+		// timestamps
+		int64 getTimestamp();
+		static int64 now();
+
+		// pacing
+		void setPacing(PSFramePacing newPacing);
+		PSFramePacing getPacing();
+
+
+	protected:
+
+		// frames
+		virtual bool readFrame(cv::Mat &frame) = 0;
+		virtual bool grabFrame(std::vector<uchar> &data);
+		int64 frameIndex;
+		int64 frameTimestamp;
+
+		// format
+		bool rawOutput;
+
+		// pacing
+		void waitForNextFrame();
+		PSFramePacing pacing;
+		int64 frameTick;
+};
@@ -0,0 +1,101 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSGStreamerSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSGStreamerSource::PSGStreamerSource(std::string pipeline)
+		: PSFrameSource(),
+		  pipeline(pipeline),
+		  capture(nullptr)
+	{
+
+		capture = new cv::VideoCapture();
+	}
+
+
+	PSGStreamerSource::~PSGStreamerSource() {
+
+		delete capture;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSGStreamerSource::open() {
+
+		frameIndex = 0;
+
+		// appsink delivers BGR frames, only the newest buffer is kept
+		std::string description = pipeline;
+		if(description.find("appsink") == std::string::npos) {
+			description += " ! videoconvert ! video/x-raw,format=BGR ! appsink drop=true max-buffers=1 sync=false";
+		}
+
+		return capture->open(description, cv::CAP_GSTREAMER);
+	}
+
+
+	void PSGStreamerSource::close() {
+
+		capture->release();
+	}
+
+
+	bool PSGStreamerSource::isOpened() {
+
+		return capture->isOpened();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSGStreamerSource::getFrameSize() {
+
+		return cv::Size((int) capture->get(cv::CAP_PROP_FRAME_WIDTH), (int) capture->get(cv::CAP_PROP_FRAME_HEIGHT));
+	}
+
+
+	double PSGStreamerSource::getFps() {
+
+		double fps = capture->get(cv::CAP_PROP_FPS);
+		return fps > 0 ? fps : PSFrameSource::getFps();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSGStreamerSource::readFrame(cv::Mat &frame) {
+
+		return capture->read(frame);
+	}
@@ -0,0 +1,58 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Reads frames from a GStreamer pipeline ending in an appsink, e.g. "videotestsrc pattern=ball" or
+ * "filesrc location=table.mp4 ! decodebin". A BGR appsink is appended if the pipeline has none.
+ */
+
+class PSGStreamerSource : public PSFrameSource {
+
+	public:
+
+		PSGStreamerSource(std::string pipeline);
+		~PSGStreamerSource();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+
+
+	private:
+
+		// pipeline
+		std::string pipeline;
+		cv::VideoCapture *capture;
+};
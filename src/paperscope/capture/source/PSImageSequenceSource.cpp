@@ -0,0 +1,119 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSImageSequenceSource.h"
+
+	// Qt
+	#include <QDir>
+	#include <QFile>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSImageSequenceSource::PSImageSequenceSource(QString directoryPath, double fps)
+		: PSFrameSource(),
+		  directoryPath(directoryPath),
+		  fps(fps)
+	{
+
+	}
+
+
+	PSImageSequenceSource::~PSImageSequenceSource() {
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSImageSequenceSource::open() {
+
+		frameIndex = 0;
+		files.clear();
+
+		// collect frames sorted by file name
+		QDir dir(directoryPath);
+		QStringList filters = {"*.png", "*.PNG", "*.jpg", "*.JPG", "*.jpeg", "*.JPEG"};
+		QStringList names = dir.entryList(filters, QDir::Files, QDir::Name);
+		for(const QString &name : names) { files.append(dir.absoluteFilePath(name)); }
+		if(files.isEmpty()) { return false; }
+
+		// frame size of the sequence
+		cv::Mat first = cv::imread(files[0].toStdString(), cv::IMREAD_COLOR);
+		frameSize = first.size();
+
+		return !first.empty();
+	}
+
+
+	void PSImageSequenceSource::close() {
+
+		files.clear();
+	}
+
+
+	bool PSImageSequenceSource::isOpened() {
+
+		return !files.isEmpty();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSImageSequenceSource::getFrameSize() {
+
+		return frameSize;
+	}
+
+
+	double PSImageSequenceSource::getFps() {
+
+		return fps;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSImageSequenceSource::readFrame(cv::Mat &frame) {
+
+		if(files.isEmpty()) { return false; }
+
+		// loop sequence
+		QFile file(files[frameIndex % files.size()]);
+		if(!file.open(QFile::ReadOnly)) { return false; }
+		fileData.resize(file.size());
+		if(file.read((char*) fileData.data(), fileData.size()) != (qint64) fileData.size()) { return false; }
+
+		// decode into the frame passed in, its buffer is reused if the size matches
+		cv::imdecode(fileData, cv::IMREAD_COLOR, &frame);
+
+		return !frame.empty();
+	}
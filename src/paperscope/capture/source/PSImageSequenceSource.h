@@ -0,0 +1,64 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// Qt
+	#include <QString>
+	#include <QStringList>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Replays a directory of PNG/JPEG frames in file name order.
+ */
+
+class PSImageSequenceSource : public PSFrameSource {
+
+	public:
+
+		PSImageSequenceSource(QString directoryPath, double fps = 30.0);
+		~PSImageSequenceSource();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+
+
+	private:
+
+		// images
+		QString directoryPath;
+		QStringList files;
+		std::vector<uchar> fileData;
+		cv::Size frameSize;
+		double fps;
+};
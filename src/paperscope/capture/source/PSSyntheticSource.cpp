@@ -0,0 +1,204 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSSyntheticSource.h"
+
+	// OpenCV
+	#include <opencv2/objdetect/aruco_detector.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSSyntheticSource::PSSyntheticSource(cv::Size frameSize, double fps, Generator generator)
+		: PSFrameSource(),
+		  generator(generator),
+		  pieceCount(0),
+		  isOpen(false),
+		  frameSize(frameSize),
+		  fps(fps)
+	{
+
+	}
+
+
+	PSSyntheticSource::~PSSyntheticSource() {
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSSyntheticSource::open() {
+
+		frameIndex = 0;
+		isOpen = true;
+
+		// tracking marker used by PSCapture
+		cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_ARUCO_ORIGINAL);
+		cv::aruco::generateImageMarker(dictionary, 16, 200, marker);
+		cv::cvtColor(marker, marker, cv::COLOR_GRAY2BGR);
+
+		return true;
+	}
+
+
+	void PSSyntheticSource::close() {
+
+		isOpen = false;
+	}
+
+
+	bool PSSyntheticSource::isOpened() {
+
+		return isOpen;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSSyntheticSource::getFrameSize() {
+
+		return frameSize;
+	}
+
+
+	double PSSyntheticSource::getFps() {
+
+		return fps;
+	}
+
+
+	/**
+	 * Number of small pieces drawn instead of the default shapes, 0 draws the default table.
+	 */
+
+	void PSSyntheticSource::setPieceCount(int count) {
+
+		pieceCount = count;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSSyntheticSource::readFrame(cv::Mat &frame) {
+
+		if(!isOpen) { return false; }
+
+		frame.create(frameSize, CV_8UC3);
+
+		if(generator) { generator(frame, frameIndex); }
+		else { drawTable(frame, frameIndex); }
+
+		return true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	GENERATOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Draw an A4 landscape sheet with the marker in the top left corner. One rectangle moves slowly
+	 * across the sheet, everything else is static.
+	 */
+
+	void PSSyntheticSource::drawTable(cv::Mat &frame, int64 index) {
+
+		frame.setTo(cv::Scalar(90, 90, 90));
+
+		// sheet in pixels per meter
+		float scale = frameSize.height * 0.85f / 0.210f;
+		cv::Point2f origin((frameSize.width - 0.300f * scale) / 2.0f, (frameSize.height - 0.210f * scale) / 2.0f);
+		auto toPixel = [&](float x, float y) { return cv::Point(cvRound(origin.x + x * scale), cvRound(origin.y + y * scale)); };
+		cv::rectangle(frame, toPixel(0, 0), toPixel(0.300f, 0.210f), cv::Scalar(245, 245, 245), -1);
+
+		// marker with padding
+		int markerSide = cvRound(0.030f * scale);
+		cv::Mat markerScaled;
+		cv::resize(marker, markerScaled, cv::Size(markerSide, markerSide), 0, 0, cv::INTER_NEAREST);
+		markerScaled.copyTo(frame(cv::Rect(toPixel(0.013f, 0.013f), markerScaled.size())));
+
+		if(pieceCount > 0) {
+			drawCrowd(frame, index, toPixel, scale);
+			return;
+		}
+
+		// static pieces
+		cv::rectangle(frame, toPixel(0.080f, 0.040f), toPixel(0.120f, 0.070f), cv::Scalar(180, 90, 20), -1);
+		cv::circle(frame, toPixel(0.200f, 0.060f), cvRound(0.018f * scale), cv::Scalar(40, 200, 230), -1);
+
+		std::vector<cv::Point> triangle = { toPixel(0.220f, 0.170f), toPixel(0.260f, 0.170f), toPixel(0.240f, 0.135f) };
+		cv::fillConvexPoly(frame, triangle, cv::Scalar(60, 160, 60));
+
+		// street
+		std::vector<cv::Point> street = { toPixel(0.030f, 0.190f), toPixel(0.150f, 0.150f), toPixel(0.280f, 0.110f) };
+		cv::polylines(frame, street, false, cv::Scalar(40, 40, 210), cvRound(0.004f * scale), cv::LINE_AA);
+
+		// moving piece
+		float t = (float) (index % 600) / 600.0f;
+		float x = 0.060f + 0.150f * (t < 0.5f ? t * 2.0f : (1.0f - t) * 2.0f);
+		cv::rectangle(frame, toPixel(x, 0.110f), toPixel(x + 0.025f, 0.135f), cv::Scalar(30, 30, 30), -1);
+	}
+
+
+	/**
+	 * Grid of 9 mm pieces with alternating shapes and colours, 16 x 10 cells right of the marker. The last
+	 * piece jumps to the next free cell and back every second, so change detection still sees motion.
+	 */
+
+	void PSSyntheticSource::drawCrowd(cv::Mat &frame, int64 index, std::function<cv::Point(float, float)> toPixel, float scale) {
+
+		const cv::Scalar colors[] = { cv::Scalar(180, 90, 20), cv::Scalar(40, 200, 230), cv::Scalar(60, 160, 60), cv::Scalar(30, 30, 30) };
+		int count = std::min(pieceCount, 159);
+		int radius = cvRound(0.0045f * scale);
+
+		for(int i = 0; i < count; i++) {
+
+			int cell = i == count - 1 && (index / 30) % 2 == 1 ? i + 1 : i;
+			cv::Point center = toPixel(0.0575f + (cell % 16) * 0.015f, 0.0575f + (cell / 16) * 0.015f);
+			cv::Scalar color = colors[i % 4];
+
+			if(i % 3 == 0) {
+				cv::rectangle(frame, center - cv::Point(radius, radius), center + cv::Point(radius, radius), color, -1);
+			}
+			else if(i % 3 == 1) {
+				cv::circle(frame, center, radius, color, -1);
+			}
+			else {
+				std::vector<cv::Point> triangle = { center + cv::Point(-radius, radius), center + cv::Point(radius, radius), center + cv::Point(0, -radius) };
+				cv::fillConvexPoly(frame, triangle, color);
+			}
+		}
+	}
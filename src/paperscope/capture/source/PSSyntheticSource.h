@@ -0,0 +1,75 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <functional>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Renders frames with a generator function. Without a custom generator a paper sheet with the
+ * tracking marker and a few shapes is drawn, which is enough to run the whole pipeline without a camera.
+ * With a piece count the sheet is filled with a grid of small pieces instead to benchmark crowded tables.
+ */
+
+class PSSyntheticSource : public PSFrameSource {
+
+	public:
+
+		typedef std::function<void(cv::Mat &frame, int64 frameIndex)> Generator;
+
+		PSSyntheticSource(cv::Size frameSize = cv::Size(1280, 720), double fps = 30.0, Generator generator = nullptr);
+		~PSSyntheticSource();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+
+		// generator
+		void setPieceCount(int count);
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+
+
+	private:
+
+		// generator
+		void drawTable(cv::Mat &frame, int64 index);
+		void drawCrowd(cv::Mat &frame, int64 index, std::function<cv::Point(float, float)> toPixel, float scale);
+		Generator generator;
+		int pieceCount;
+		cv::Mat marker;
+		bool isOpen;
+
+		// format
+		cv::Size frameSize;
+		double fps;
+};
@@ -0,0 +1,375 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSV4L2Source.h"
+
+	// Linux
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/ioctl.h>
+	#include <sys/mman.h>
+	#include <cerrno>
+
+	// Qt
+	#include <QDebug>
+	#include <QMediaDevices>
+	#include <QCameraDevice>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSV4L2Source::PSV4L2Source(std::string devicePath, PSCameraFormat format)
+		: PSFrameSource(),
+		  devicePath(devicePath),
+		  fd(-1),
+		  format(format),
+		  pixelFormat(0),
+		  bytesPerLine(0),
+		  fps(format.fps),
+		  isStreaming(false)
+	{
+
+	}
+
+
+	PSV4L2Source::~PSV4L2Source() {
+
+		close();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSV4L2Source::open() {
+
+		close();
+
+		fd = ::open(devicePath.c_str(), O_RDWR | O_NONBLOCK);
+		if(fd < 0) {
+			qDebug() << "v4l2: could not open" << devicePath.c_str();
+			return false;
+		}
+
+		if(!setFormat() || !initBuffers()) {
+			close();
+			return false;
+		}
+
+		// start streaming
+		v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		if(xioctl(VIDIOC_STREAMON, &type) < 0) {
+			close();
+			return false;
+		}
+
+		isStreaming = true;
+		frameIndex = 0;
+
+		return true;
+	}
+
+
+	void PSV4L2Source::close() {
+
+		if(fd < 0) { return; }
+
+		if(isStreaming) {
+			v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			xioctl(VIDIOC_STREAMOFF, &type);
+			isStreaming = false;
+		}
+
+		releaseBuffers();
+
+		::close(fd);
+		fd = -1;
+	}
+
+
+	bool PSV4L2Source::isOpened() {
+
+		return fd >= 0 && isStreaming;
+	}
+
+
+	bool PSV4L2Source::isLive() {
+
+		return true;
+	}
+
+
+	bool PSV4L2Source::isEncoded() {
+
+		return pixelFormat == V4L2_PIX_FMT_MJPEG;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSV4L2Source::getFrameSize() {
+
+		return frameSize;
+	}
+
+
+	double PSV4L2Source::getFps() {
+
+		return fps;
+	}
+
+
+	PSPixelFormat PSV4L2Source::getPixelFormat() {
+
+		if(rawOutput && pixelFormat == V4L2_PIX_FMT_YUYV) { return PSPixelFormat::YUYV; }
+		if(rawOutput && pixelFormat == V4L2_PIX_FMT_NV12) { return PSPixelFormat::NV12; }
+
+		return PSPixelFormat::BGR;
+	}
+
+
+	/**
+	 * Negotiate resolution, pixel format and frame rate. The driver may adjust the request, the negotiated values are read back.
+	 */
+
+	bool PSV4L2Source::setFormat() {
+
+		// requested pixel format
+		const std::string &name = format.pixelFormat;
+		if(name == "MJPG" || name == "MJPEG") { pixelFormat = V4L2_PIX_FMT_MJPEG; }
+		else if(name == "YUYV" || name == "YUY2") { pixelFormat = V4L2_PIX_FMT_YUYV; }
+		else { pixelFormat = V4L2_PIX_FMT_NV12; }
+
+		v4l2_format fmt = {};
+		fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		fmt.fmt.pix.width = format.width;
+		fmt.fmt.pix.height = format.height;
+		fmt.fmt.pix.pixelformat = pixelFormat;
+		fmt.fmt.pix.field = V4L2_FIELD_ANY;
+		if(xioctl(VIDIOC_S_FMT, &fmt) < 0) { return false; }
+
+		// negotiated format
+		pixelFormat = fmt.fmt.pix.pixelformat;
+		bytesPerLine = fmt.fmt.pix.bytesperline;
+		frameSize = cv::Size(fmt.fmt.pix.width, fmt.fmt.pix.height);
+
+		if(pixelFormat != V4L2_PIX_FMT_MJPEG && pixelFormat != V4L2_PIX_FMT_YUYV && pixelFormat != V4L2_PIX_FMT_NV12) {
+			qDebug() << "v4l2: unsupported pixel format" << pixelFormat;
+			return false;
+		}
+
+		// frame rate
+		v4l2_streamparm parm = {};
+		parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		parm.parm.capture.timeperframe.numerator = 1;
+		parm.parm.capture.timeperframe.denominator = format.fps;
+		if(xioctl(VIDIOC_S_PARM, &parm) == 0 && parm.parm.capture.timeperframe.numerator > 0) {
+			fps = (double) parm.parm.capture.timeperframe.denominator / parm.parm.capture.timeperframe.numerator;
+		}
+
+		return true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	BUFFERS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSV4L2Source::initBuffers() {
+
+		v4l2_requestbuffers request = {};
+		request.count = 4;
+		request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		request.memory = V4L2_MEMORY_MMAP;
+		if(xioctl(VIDIOC_REQBUFS, &request) < 0 || request.count < 2) { return false; }
+
+		// map driver buffers and hand them to the driver
+		for(uint32_t i = 0; i < request.count; i++) {
+
+			v4l2_buffer buf = {};
+			buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			buf.memory = V4L2_MEMORY_MMAP;
+			buf.index = i;
+			if(xioctl(VIDIOC_QUERYBUF, &buf) < 0) { return false; }
+
+			void *start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+			if(start == MAP_FAILED) { return false; }
+			buffers.push_back({start, buf.length});
+
+			if(xioctl(VIDIOC_QBUF, &buf) < 0) { return false; }
+		}
+
+		return true;
+	}
+
+
+	void PSV4L2Source::releaseBuffers() {
+
+		for(Buffer &buffer : buffers) { munmap(buffer.start, buffer.length); }
+		buffers.clear();
+
+		v4l2_requestbuffers request = {};
+		request.count = 0;
+		request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		request.memory = V4L2_MEMORY_MMAP;
+		xioctl(VIDIOC_REQBUFS, &request);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSV4L2Source::readFrame(cv::Mat &frame) {
+
+		v4l2_buffer buf = {};
+		if(!dequeueBuffer(buf)) { return false; }
+
+		// decode straight from the mapped driver buffer into the frame
+		bool success = decodeFrame((uint8_t*) buffers[buf.index].start, buf.bytesused, frame);
+		queueBuffer(buf);
+
+		return success;
+	}
+
+
+	/**
+	 * Copy the compressed MJPEG data out of the driver buffer, decoding is done by the caller.
+	 */
+
+	bool PSV4L2Source::grabFrame(std::vector<uchar> &data) {
+
+		v4l2_buffer buf = {};
+		if(!dequeueBuffer(buf)) { return false; }
+
+		uint8_t *start = (uint8_t*) buffers[buf.index].start;
+		data.assign(start, start + buf.bytesused);
+		queueBuffer(buf);
+
+		return true;
+	}
+
+
+	/**
+	 * Wait for the next filled buffer and take the driver timestamp of the capture.
+	 */
+
+	bool PSV4L2Source::dequeueBuffer(v4l2_buffer &buf) {
+
+		if(!isOpened()) { return false; }
+
+		pollfd pfd = {fd, POLLIN, 0};
+		if(poll(&pfd, 1, 1000) <= 0) { return false; }
+
+		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buf.memory = V4L2_MEMORY_MMAP;
+		if(xioctl(VIDIOC_DQBUF, &buf) < 0) { return false; }
+
+		// skip corrupted frames
+		if(buf.flags & V4L2_BUF_FLAG_ERROR) {
+			queueBuffer(buf);
+			return false;
+		}
+
+		if((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+			frameTimestamp = (int64) buf.timestamp.tv_sec * 1000000 + buf.timestamp.tv_usec;
+		}
+
+		return true;
+	}
+
+
+	void PSV4L2Source::queueBuffer(v4l2_buffer &buf) {
+
+		// return buffer to driver
+		xioctl(VIDIOC_QBUF, &buf);
+	}
+
+
+	bool PSV4L2Source::decodeFrame(uint8_t *data, size_t bytesUsed, cv::Mat &frame) {
+
+		int w = frameSize.width;
+		int h = frameSize.height;
+
+		// raw output only copies the planes out of the driver buffer
+		if(pixelFormat == V4L2_PIX_FMT_YUYV) {
+			cv::Mat yuyv(h, w, CV_8UC2, data, bytesPerLine);
+			if(rawOutput) { yuyv.copyTo(frame); }
+			else { cv::cvtColor(yuyv, frame, cv::COLOR_YUV2BGR_YUYV); }
+		}
+		else if(pixelFormat == V4L2_PIX_FMT_NV12) {
+			cv::Mat nv12(h * 3 / 2, w, CV_8UC1, data, bytesPerLine);
+			if(rawOutput) { nv12.copyTo(frame); }
+			else { cv::cvtColor(nv12, frame, cv::COLOR_YUV2BGR_NV12); }
+		}
+		else {
+			cv::Mat jpeg(1, (int) bytesUsed, CV_8UC1, data);
+			cv::imdecode(jpeg, cv::IMREAD_COLOR, &frame);
+		}
+
+		return !frame.empty();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	DEVICE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	int PSV4L2Source::xioctl(unsigned long request, void *arg) {
+
+		int result;
+		do { result = ioctl(fd, request, arg); } while(result < 0 && errno == EINTR);
+
+		return result;
+	}
+
+
+	/**
+	 * Qt reports the device node as camera id on Linux.
+	 */
+
+	std::string PSV4L2Source::findDevice(QString description) {
+
+		QList<QCameraDevice> availableCameras = QMediaDevices::videoInputs();
+		for(int i = 0; i < availableCameras.size(); i++) {
+			if(availableCameras[i].description() == description) {
+				return availableCameras[i].id().toStdString();
+			}
+		}
+
+		return "/dev/video0";
+	}
@@ -0,0 +1,101 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <cstdint>
+	#include <vector>
+
+	// Linux
+	#include <linux/videodev2.h>
+
+	// Qt
+	#include <QString>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+	#include "PSCameraFormat.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Linux camera backend on top of V4L2 memory mapped buffers. Driver buffers are wrapped in cv::Mat headers
+ * and decoded directly into the frame passed to read(), so no intermediate copy is made. Frames carry the
+ * monotonic driver timestamp of the capture.
+ */
+
+class PSV4L2Source : public PSFrameSource {
+
+	public:
+
+		PSV4L2Source(std::string devicePath, PSCameraFormat format);
+		~PSV4L2Source();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+		bool isLive() override;
+		bool isEncoded() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+		PSPixelFormat getPixelFormat() override;
+
+		// device
+		static std::string findDevice(QString description);
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+		bool grabFrame(std::vector<uchar> &data) override;
+
+
+	private:
+
+		// device
+		int xioctl(unsigned long request, void *arg);
+		std::string devicePath;
+		int fd;
+
+		// format
+		bool setFormat();
+		PSCameraFormat format;
+		uint32_t pixelFormat;
+		uint32_t bytesPerLine;
+		cv::Size frameSize;
+		double fps;
+
+		// buffers
+		struct Buffer {
+			void *start;
+			size_t length;
+		};
+		bool initBuffers();
+		void releaseBuffers();
+		bool dequeueBuffer(v4l2_buffer &buf);
+		void queueBuffer(v4l2_buffer &buf);
+		std::vector<Buffer> buffers;
+		bool isStreaming;
+
+		// decode
+		bool decodeFrame(uint8_t *data, size_t bytesUsed, cv::Mat &frame);
+};
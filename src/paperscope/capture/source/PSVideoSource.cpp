@@ -0,0 +1,98 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSVideoSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSVideoSource::PSVideoSource(std::string filePath)
+		: PSFrameSource(),
+		  filePath(filePath),
+		  capture(nullptr)
+	{
+
+		capture = new cv::VideoCapture();
+	}
+
+
+	PSVideoSource::~PSVideoSource() {
+
+		delete capture;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SOURCE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSVideoSource::open() {
+
+		frameIndex = 0;
+		return capture->open(filePath);
+	}
+
+
+	void PSVideoSource::close() {
+
+		capture->release();
+	}
+
+
+	bool PSVideoSource::isOpened() {
+
+		return capture->isOpened();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FORMAT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	cv::Size PSVideoSource::getFrameSize() {
+
+		return cv::Size((int) capture->get(cv::CAP_PROP_FRAME_WIDTH), (int) capture->get(cv::CAP_PROP_FRAME_HEIGHT));
+	}
+
+
+	double PSVideoSource::getFps() {
+
+		double fps = capture->get(cv::CAP_PROP_FPS);
+		return fps > 0 ? fps : PSFrameSource::getFps();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	FRAMES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	bool PSVideoSource::readFrame(cv::Mat &frame) {
+
+		if(capture->read(frame)) { return true; }
+
+		// restart video at the end of the file
+		capture->set(cv::CAP_PROP_POS_FRAMES, 0);
+		return capture->read(frame);
+	}
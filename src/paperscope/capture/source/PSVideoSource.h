@@ -0,0 +1,57 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSFrameSource.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Replays a recorded video file in a loop.
+ */
+
+class PSVideoSource : public PSFrameSource {
+
+	public:
+
+		PSVideoSource(std::string filePath);
+		~PSVideoSource();
+
+		// source
+		bool open() override;
+		void close() override;
+		bool isOpened() override;
+
+		// format
+		cv::Size getFrameSize() override;
+		double getFps() override;
+
+
+	protected:
+
+		// frames
+		bool readFrame(cv::Mat &frame) override;
+
+
+	private:
+
+		// video
+		std::string filePath;
+		cv::VideoCapture *capture;
+};
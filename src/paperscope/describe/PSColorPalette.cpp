@@ -0,0 +1,199 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSColorPalette.h"
+
+	// C++
+	#include <limits>
+
+	// Qt
+	#include <QJsonArray>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSColorPalette::PSColorPalette() {
+
+		loadDefault();
+		buildTable();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	PALETTE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Palette of the project, e.g. "palette": [{"name": "blue", "color": "#2060a0"}, {"name": "yellow", "colors":
+	 * ["#ebd040", "#9b7f30"]}]. Projects without valid palette use the default colors.
+	 */
+
+	void PSColorPalette::load(QJsonObject project) {
+
+		colors.clear();
+
+		QJsonArray palette = project.value("palette").toArray();
+		for(const QJsonValue &value : palette) {
+
+			QJsonObject entry = value.toObject();
+			QJsonArray hexColors = entry.value("colors").toArray();
+			if(!entry.contains("colors")) { hexColors.append(entry.value("color")); }
+
+			Color color;
+			color.name = entry.value("name").toString().toStdString();
+			for(const QJsonValue &hex : hexColors) {
+				cv::Vec3b bgr;
+				if(parseHex(hex.toString(), bgr)) { color.prototypes.push_back(bgr); }
+			}
+
+			if(!color.prototypes.empty()) { colors.push_back(color); }
+		}
+
+		// palette indices are stored in a byte
+		if(colors.size() > 255) { colors.resize(255); }
+		if(colors.empty()) { loadDefault(); }
+
+		buildTable();
+	}
+
+
+	int PSColorPalette::getCount() {
+
+		return (int) colors.size();
+	}
+
+
+	std::string PSColorPalette::getName(int index) {
+
+		if(index < 0 || index >= (int) colors.size()) { return ""; }
+
+		return colors[index].name;
+	}
+
+
+	/**
+	 * Black, blue, green and yellow paper, defined in OpenCV HSV.
+	 */
+
+	void PSColorPalette::loadDefault() {
+
+		std::vector<std::pair<std::string, std::vector<cv::Vec3b>>> hsvColors = {
+			{"black", {cv::Vec3b(90, 20, 20)}},
+			{"blue", {cv::Vec3b(110, 165, 128)}},
+			{"green", {cv::Vec3b(75, 153, 128)}},
+			{"yellow", {cv::Vec3b(43, 140, 235), cv::Vec3b(25, 153, 155)}}
+		};
+
+		colors.clear();
+		for(auto &[name, prototypes] : hsvColors) {
+
+			Color color;
+			color.name = name;
+			for(cv::Vec3b &hsv : prototypes) {
+				cv::Mat bgr;
+				cv::cvtColor(cv::Mat(1, 1, CV_8UC3, hsv.val), bgr, cv::COLOR_HSV2BGR);
+				color.prototypes.push_back(bgr.at<cv::Vec3b>(0, 0));
+			}
+			colors.push_back(color);
+		}
+	}
+
+
+	bool PSColorPalette::parseHex(QString hex, cv::Vec3b &bgr) {
+
+		if(hex.startsWith("#")) { hex = hex.mid(1); }
+		if(hex.length() != 6) { return false; }
+
+		bool ok = false;
+		uint rgb = hex.toUInt(&ok, 16);
+		if(!ok) { return false; }
+
+		bgr = cv::Vec3b(rgb & 0xFF, (rgb >> 8) & 0xFF, (rgb >> 16) & 0xFF);
+		return true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TABLE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Palette index of the center of every quantized BGR cell. All cells are converted to Lab in a single
+	 * call, the closest prototype is searched by squared distance.
+	 */
+
+	void PSColorPalette::buildTable() {
+
+		int levels = 1 << bits;
+		int step = 256 / levels;
+
+		// cell centers
+		cv::Mat cells(levels * levels, levels, CV_8UC3);
+		for(int b = 0; b < levels; b++) {
+			for(int g = 0; g < levels; g++) {
+				cv::Vec3b *row = cells.ptr<cv::Vec3b>(b * levels + g);
+				for(int r = 0; r < levels; r++) { row[r] = cv::Vec3b(b * step + step / 2, g * step + step / 2, r * step + step / 2); }
+			}
+		}
+
+		cv::Mat cellsLab;
+		cells.convertTo(cellsLab, CV_32FC3, 1.0 / 255.0);
+		cv::cvtColor(cellsLab, cellsLab, cv::COLOR_BGR2Lab);
+
+		// prototypes
+		std::vector<cv::Vec3f> prototypes;
+		std::vector<uchar> indices;
+		for(size_t i = 0; i < colors.size(); i++) {
+			for(cv::Vec3b &bgr : colors[i].prototypes) {
+				cv::Mat lab;
+				cv::Mat(1, 1, CV_8UC3, bgr.val).convertTo(lab, CV_32FC3, 1.0 / 255.0);
+				cv::cvtColor(lab, lab, cv::COLOR_BGR2Lab);
+				prototypes.push_back(lab.at<cv::Vec3f>(0, 0));
+				indices.push_back((uchar) i);
+			}
+		}
+
+		table.assign(cellsLab.total(), 0);
+		const cv::Vec3f *lab = cellsLab.ptr<cv::Vec3f>(0);
+		for(size_t i = 0; i < table.size(); i++) {
+
+			float minDistance = std::numeric_limits<float>::max();
+			for(size_t j = 0; j < prototypes.size(); j++) {
+				cv::Vec3f difference = lab[i] - prototypes[j];
+				float distance = difference.dot(difference);
+				if(distance < minDistance) {
+					minDistance = distance;
+					table[i] = indices[j];
+				}
+			}
+		}
+	}
+
+
+	int PSColorPalette::classify(cv::Scalar bgr) {
+
+		int shift = 8 - bits;
+		int b = cv::saturate_cast<uchar>(bgr[0]) >> shift;
+		int g = cv::saturate_cast<uchar>(bgr[1]) >> shift;
+		int r = cv::saturate_cast<uchar>(bgr[2]) >> shift;
+
+		return table[(b << (2 * bits)) | (g << bits) | r];
+	}
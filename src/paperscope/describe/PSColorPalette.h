@@ -0,0 +1,66 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <string>
+	#include <vector>
+
+	// Qt
+	#include <QJsonObject>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Marker colors of a project. Every color has a name and one or more BGR prototypes, read from the "palette"
+ * of the project JSON. A table over the BGR cube, quantized to 5 bits per channel, holds the index of the
+ * closest prototype in Lab. It is rebuilt when the palette changes, classifying a color is a single lookup.
+ */
+
+class PSColorPalette {
+
+	public:
+
+		PSColorPalette();
+
+		// palette
+		void load(QJsonObject project);
+		int getCount();
+		std::string getName(int index);
+
+		// lookup
+		int classify(cv::Scalar bgr);
+
+
+	private:
+
+		struct Color {
+			std::string name;
+			std::vector<cv::Vec3b> prototypes;
+		};
+
+		// palette
+		void loadDefault();
+		bool parseHex(QString hex, cv::Vec3b &bgr);
+		std::vector<Color> colors;
+
+		// table
+		void buildTable();
+		static const int bits = 5;
+		std::vector<uchar> table;
+};
@@ -7,6 +7,13 @@
 
 	#include "PSDescribe.h"
 
+	// C++
+	#include <algorithm>
+	#include <cmath>
+	#include <functional>
+	#include <limits>
+	#include <map>
+
 	// Qt
 	#include <QJsonArray>
 	#include <QDebug>
@@ -31,7 +38,9 @@
 	PSDescribe::PSDescribe(QObject *parent)
 		: QObject(parent),
 		  matTracking(nullptr),
-		  matRender(nullptr)
+		  renderLayer(nullptr),
+		  palette(nullptr),
+		  sceneDiff(nullptr)
 	{
 
 		// init properties
@@ -39,15 +48,31 @@
 		viewMode = PSViewMode::Threshold;
 		needsRequest = false;
 		isSending = false;
-		timestampSent = QDateTime::currentSecsSinceEpoch();
+		isDeltaSupported = true;
+		timestampSent = QDateTime::currentMSecsSinceEpoch();
+		nextId = 1;
+		trackSpawn = Settings::instance()->getInt("track_spawn", 5);
+		trackKill = Settings::instance()->getInt("track_kill", 25);
+		trackGate = Settings::instance()->getInt("track_gate", 20);
+		colorInterval = Settings::instance()->getInt("color_interval", 30);
+		palette = new PSColorPalette();
+		palette->load(Settings::instance()->getJsonObject("project"));
+		hasPendingProject = false;
+		sceneInterval = Settings::instance()->getInt("scene_interval", 1000);
+		sceneDiff = new PSSceneDiff();
+		sceneDiff->tolerance = Settings::instance()->getFloat("scene_tolerance", 0.002);
 
 		// init member
 		connect(this, &PSDescribe::sceneUpdated, Api::instance(), &Api::post);
+		// the processing thread runs no event loop, errors are handled on the main thread
+		connect(Api::instance(), &Api::error, this, &PSDescribe::onRequestFailed, Qt::DirectConnection);
 	}
 
 
 	PSDescribe::~PSDescribe() {
 
+		delete palette;
+		delete sceneDiff;
 	}
 
 
@@ -64,15 +89,20 @@
 	}
 
 
-	void PSDescribe::update(cv::Mat *mTracking, cv::Mat *mRender, cv::Mat *mStreets, PSTrackingMode trackingMode, std::vector<PSCandidate> &candidates) {
+	void PSDescribe::update(cv::Mat *mTracking, PSRenderLayer *layer, cv::Mat *mStreets, PSTrackingMode trackingMode, std::vector<PSCandidate> &candidates) {
 
 		matTracking = mTracking;
-		matRender = mRender;
+		renderLayer = layer;
 		matStreets = mStreets;
 
+		updatePalette();
+
 		// skip loop
 		if(trackingMode != PSTrackingMode::Tracking || matTracking->empty()) {
-			if(!objects.empty()) { objects.clear(); }
+			if(!objects.empty()) {
+				objects.clear();
+				freeSlots.clear();
+			}
 			return;
 		}
 		
@@ -97,50 +127,294 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	void PSDescribe::updateScene(std::vector<PSCandidate> &candidates) {
+	/**
+	 * Track the objects of the scene with the candidates of the frame. Every object predicts its position
+	 * with a constant velocity, candidates are matched against the predictions. Objects are found through a
+	 * grid over their predicted bounding boxes, the geometry of each candidate is computed once. Every object
+	 * is updated by at most one candidate, the assignment with the lowest total distance wins. Candidates
+	 * matching only objects taken by others are duplicates and do not create new objects.
+	 *
+	 * New objects are tentative until they were matched on trackSpawn frames and removed on their second
+	 * miss, confirmed objects survive trackKill frames without candidate. Only confirmed objects are sent.
+	 */
 
-		int countObjects = 0;
+	void PSDescribe::updateScene(std::vector<PSCandidate> &candidates) {
 
-		// update confidence of existing objects
-		for(PSObject &object : objects) { 
-			object.confidence -= 4;
-			if(object.confidence > 20) { countObjects++; }
+		// predict and index objects, streets only match by center
+		grid.reset(matTracking->size());
+		for(int slot = 0; slot < (int) objects.size(); slot++) {
+			if(!objects[slot].isActive) { continue; }
+			objects[slot].predict();
+			cv::Point predicted(cvRound(objects[slot].position.x), cvRound(objects[slot].position.y));
+			if(objects[slot].shapeType == PSShapeType::Street) { grid.insert(slot, cv::Rect(predicted, cv::Size(1, 1))); }
+			else { grid.insert(slot, objects[slot].getPredictedRect()); }
 		}
 
-		// iterate all candidates
-		for(PSCandidate &candidate : candidates) {
+		// geometry of every candidate
+		std::vector<Geometry> geometry(candidates.size());
+		for(size_t i = 0; i < candidates.size(); i++) {
+			geometry[i].points = candidates[i].getPoints();
+			geometry[i].rect = cv::boundingRect(geometry[i].points);
+			geometry[i].center = cv::Point(geometry[i].rect.x + geometry[i].rect.width / 2, geometry[i].rect.y + geometry[i].rect.height / 2);
+		}
 
-			// check if object already exists
-			bool found = false;
-			for(PSObject &object : objects) {
-				if(object.isSame(candidate.getPoints(), candidate.shapeType)) {
-					found = true;
-					break;
+		// candidate and object pairs, the margin covers the gate
+		int margin = (int) std::ceil(trackGate);
+		std::vector<Match> matches;
+		std::vector<bool> isMatched(candidates.size(), false);
+		std::vector<int> nearby;
+		for(size_t i = 0; i < candidates.size(); i++) {
+			cv::Rect area(geometry[i].rect.x - margin, geometry[i].rect.y - margin, geometry[i].rect.width + 2 * margin, geometry[i].rect.height + 2 * margin);
+			grid.query(area, nearby);
+			for(int slot : nearby) {
+				float cost;
+				if(objects[slot].matches(geometry[i].rect, geometry[i].center, candidates[i].shapeType, trackGate, cost)) {
+					matches.push_back({(int) i, slot, cost});
+					isMatched[i] = true;
 				}
 			}
+		}
 
-			// create object from candidate
-			if(!found) {
-				PSObject object(candidate.getPoints(), candidate.shapeType, matTracking, matRender);
-				objects.push_back(object);
+		// update assigned objects, create objects from new candidates
+		std::vector<int> assigned = assignMatches(matches, (int) candidates.size());
+		std::vector<bool> isUpdated(objects.size(), false);
+		for(size_t i = 0; i < candidates.size(); i++) {
+			if(assigned[i] >= 0) {
+				if(objects[assigned[i]].update(geometry[i].points, candidates[i].shapeType, trackSpawn)) { needsRequest = true; }
+				isUpdated[assigned[i]] = true;
+			}
+			else if(!isMatched[i]) {
+				int slot = addObject(PSObject(geometry[i].points, candidates[i].shapeType, matTracking, renderLayer));
+				if(slot < (int) isUpdated.size()) { isUpdated[slot] = true; }
 			}
 		}
 
-		// remove old objects from scene
-		std::vector<PSObject> validObjects;
-		int countValid = 0;
-		for(int i = 0; i < (int) objects.size(); i++) {
-			if(objects[i].confidence > 0) { validObjects.push_back(objects[i]); }
-			if(objects[i].confidence > 20) { countValid++; }
+		// remove lost objects from scene
+		for(size_t slot = 0; slot < isUpdated.size(); slot++) {
+
+			PSObject &object = objects[slot];
+			if(!object.isActive || isUpdated[slot]) { continue; }
+
+			object.miss();
+			if(object.misses >= (object.isConfirmed ? trackKill : 2)) {
+				if(object.isConfirmed) { needsRequest = true; }
+				removeObject((int) slot);
+			}
 		}
-		objects = validObjects;
 
-		// check if request is needed
-		if(countObjects != countValid) { needsRequest = true; }
+		updateColors();
 		sendRequest();
 	}
 
 
+	/**
+	 * Objects keep their slot while they are in the scene, slots of removed objects are reused. The uid
+	 * counts up over the whole session.
+	 */
+
+	int PSDescribe::addObject(PSObject object) {
+
+		// ids are never reused
+		object.uid = std::to_string(nextId++);
+		if(object.hits >= trackSpawn) {
+			object.isConfirmed = true;
+			needsRequest = true;
+		}
+
+		if(freeSlots.empty()) {
+			objects.push_back(object);
+			return (int) objects.size() - 1;
+		}
+
+		int slot = freeSlots.back();
+		objects[slot] = object;
+		freeSlots.pop_back();
+
+		return slot;
+	}
+
+
+	void PSDescribe::removeObject(int slot) {
+
+		objects[slot].isActive = false;
+		freeSlots.push_back(slot);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	COLOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Colors of objects with new geometry, others are refreshed every colorInterval frames.
+	 */
+
+	void PSDescribe::updateColors() {
+
+		for(PSObject &object : objects) {
+			if(!object.isActive || !object.needsColor(colorInterval)) { continue; }
+			if(object.detectColor(colorHsv, colorMask, palette) && object.isConfirmed) { needsRequest = true; }
+		}
+	}
+
+
+	/**
+	 * Apply a palette saved on the main thread, e.g. after loading another project. All colors are measured
+	 * again on this frame.
+	 */
+
+	void PSDescribe::updatePalette() {
+
+		QJsonObject project;
+		{
+			std::lock_guard<std::mutex> lock(paletteMutex);
+			if(!hasPendingProject) { return; }
+			project = pendingProject;
+			hasPendingProject = false;
+		}
+
+		palette->load(project);
+		for(PSObject &object : objects) { object.colorAge = -1; }
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	ASSIGNMENT
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Object slot of every candidate, -1 if it is not assigned. Matches are split into groups of candidates
+	 * and objects that compete with each other, each group is solved on its own.
+	 */
+
+	std::vector<int> PSDescribe::assignMatches(std::vector<Match> &matches, int candidateCount) {
+
+		std::vector<int> assigned(candidateCount, -1);
+		if(matches.empty()) { return assigned; }
+
+		// union find over candidates, objects follow at candidateCount + slot
+		std::vector<int> parent(candidateCount + objects.size());
+		for(size_t i = 0; i < parent.size(); i++) { parent[i] = (int) i; }
+		std::function<int(int)> find = [&](int node) {
+			while(parent[node] != node) {
+				parent[node] = parent[parent[node]];
+				node = parent[node];
+			}
+			return node;
+		};
+		for(Match &match : matches) { parent[find(match.candidate)] = find(candidateCount + match.slot); }
+
+		// matches of every group
+		std::map<int, std::vector<Match>> groups;
+		for(Match &match : matches) { groups[find(match.candidate)].push_back(match); }
+
+		for(auto &[root, group] : groups) {
+
+			// single match, nothing to solve
+			if(group.size() == 1) {
+				assigned[group[0].candidate] = group[0].slot;
+				continue;
+			}
+
+			// local indices of candidates and objects
+			std::vector<int> rows, cols;
+			for(Match &match : group) {
+				if(std::find(rows.begin(), rows.end(), match.candidate) == rows.end()) { rows.push_back(match.candidate); }
+				if(std::find(cols.begin(), cols.end(), match.slot) == cols.end()) { cols.push_back(match.slot); }
+			}
+
+			// square cost matrix, pairs without match cost more than any match
+			size_t size = std::max(rows.size(), cols.size());
+			std::vector<std::vector<float>> costs(size, std::vector<float>(size, 1e6f));
+			for(Match &match : group) {
+				size_t row = std::find(rows.begin(), rows.end(), match.candidate) - rows.begin();
+				size_t col = std::find(cols.begin(), cols.end(), match.slot) - cols.begin();
+				costs[row][col] = match.cost;
+			}
+
+			std::vector<int> solution = solveAssignment(costs);
+			for(size_t row = 0; row < rows.size(); row++) {
+				int col = solution[row];
+				if(col < (int) cols.size() && costs[row][col] < 1e6f) { assigned[rows[row]] = cols[col]; }
+			}
+		}
+
+		return assigned;
+	}
+
+
+	/**
+	 * Minimum cost assignment of a square matrix with the Hungarian method, column of every row.
+	 */
+
+	std::vector<int> PSDescribe::solveAssignment(std::vector<std::vector<float>> &costs) {
+
+		int n = (int) costs.size();
+		const double infinity = std::numeric_limits<double>::max();
+
+		// potentials and matching, index 0 is a virtual column
+		std::vector<double> u(n + 1, 0.0), v(n + 1, 0.0);
+		std::vector<int> p(n + 1, 0), way(n + 1, 0);
+
+		for(int i = 1; i <= n; i++) {
+
+			p[0] = i;
+			int j0 = 0;
+			std::vector<double> minv(n + 1, infinity);
+			std::vector<bool> used(n + 1, false);
+
+			// augmenting path from row i
+			do {
+				used[j0] = true;
+				int i0 = p[j0];
+				int j1 = 0;
+				double delta = infinity;
+				for(int j = 1; j <= n; j++) {
+					if(used[j]) { continue; }
+					double current = costs[i0 - 1][j - 1] - u[i0] - v[j];
+					if(current < minv[j]) {
+						minv[j] = current;
+						way[j] = j0;
+					}
+					if(minv[j] < delta) {
+						delta = minv[j];
+						j1 = j;
+					}
+				}
+				for(int j = 0; j <= n; j++) {
+					if(used[j]) {
+						u[p[j]] += delta;
+						v[j] -= delta;
+					}
+					else {
+						minv[j] -= delta;
+					}
+				}
+				j0 = j1;
+			} while(p[j0] != 0);
+
+			do {
+				int j1 = way[j0];
+				p[j0] = p[j1];
+				j0 = j1;
+			} while(j0 != 0);
+		}
+
+		std::vector<int> solution(n, -1);
+		for(int j = 1; j <= n; j++) { solution[p[j] - 1] = j - 1; }
+
+		return solution;
+	}
+
+
 
 /*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -162,52 +436,76 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	void PSDescribe::sendRequest() {
+	/**
+	 * Only changes since the scene acknowledged by the server are sent. A full snapshot is sent on the
+	 * first request and whenever the server lost track of the versions.
+	 */
 
-		if(objects.empty() || isSending || !needsRequest || projectId.isEmpty()) { return; }
+	void PSDescribe::sendRequest() {
 
+		if(isSending || !needsRequest || projectId.isEmpty()) { return; }
 
 		// save timestamp of request
-		qint64 timestamp = QDateTime::currentSecsSinceEpoch();
-		if(timestamp - timestampSent < 4) { return; }
+		qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+		if(timestamp - timestampSent < sceneInterval) { return; }
 		timestampSent = timestamp;
 
-		QJsonObject data;
-		QJsonArray scene;
-
+		std::map<std::string, PSSceneDiff::Entry> scene;
 		for(PSObject &object : objects) {
-
-			// default properties
-			QJsonObject obj;
-			obj["uid"] = object.uid.c_str();
-			obj["shape"] = (int) object.shapeType;
-			obj["color"] = (int) object.colorIndex;
-
-			// points data
-			QJsonArray points;
-			for(cv::Point2f &point : object.points) {
-				QJsonObject p;
-				p["x"] = point.x;
-				p["y"] = point.y;
-				points.append(p);
-			}
-			obj["points"] = points;
-			
-			scene.append(obj);
+			if(!object.isActive || !object.isConfirmed) { continue; }
+			scene[object.uid] = { (int) object.shapeType, (int) object.colorIndex, object.points };
 		}
+
+		// servers without the delta endpoint always get a full snapshot
+		if(!isDeltaSupported) { sceneDiff->resync(); }
+
+		// nothing changed beyond the tolerance
+		needsRequest = false;
+		QJsonObject data;
+		bool isFull;
+		if(!sceneDiff->build(scene, data, isFull)) { return; }
 		data.insert("slug", projectId);
-		data["scene"] = scene;
 
 		// trigger api call on main thread via signal
 		isSending = true;
-		needsRequest = false;
-		emit sceneUpdated("api/project/scene/save",  data, std::bind(&PSDescribe::onRequestSent, this));
+		QString url = isFull ? "api/project/scene/save" : "api/project/scene/delta";
+		emit sceneUpdated(url, data, [this](QJsonObject data) { onRequestSent(data); });
+	}
+
+
+	void PSDescribe::onRequestSent(QJsonObject data) {
+
+		// server misses the base version of the delta
+		if(data.value("resync").toBool()) {
+			qDebug() << "scene resync";
+			sceneDiff->resync();
+			needsRequest = true;
+		}
+		else {
+			qDebug() << "scene saved";
+			sceneDiff->acknowledge();
+		}
+
+		isSending = false;
 	}
 
 
-	void PSDescribe::onRequestSent() {
+	/**
+	 * Runs on the main thread. A missing delta endpoint switches to full snapshots for the session.
+	 */
+
+	void PSDescribe::onRequestFailed(QString message, int code, QString url) {
+
+		if(!url.contains("api/project/scene")) { return; }
+
+		if(code == 404 && url.contains("api/project/scene/delta")) {
+			qDebug() << "scene deltas not supported, sending snapshots";
+			isDeltaSupported = false;
+		}
 
-		qDebug() << "scene saved";
+		// state on the server is unknown
+		sceneDiff->resync();
+		needsRequest = true;
 		isSending = false;
 	}
 
@@ -224,27 +522,26 @@
 		
 		if(renderMode != RenderMode::PaperScope || viewMode != PSViewMode::Contours) { return; }
 
-		cv::multiply(*matRender, 0.5, *matRender);
+		renderLayer->fade(0.5);
 
 		// draw objects
 		int countObjects = 0;
 		for(int i = 0; i < (int) objects.size(); i++) {
 			
-			if(objects[i].confidence < 20) { continue; }
+			if(!objects[i].isActive || !objects[i].isConfirmed) { continue; }
 			countObjects++;
 
-            objects[i].detectColor();
             objects[i].drawContour();
 
-			// draw confidence above object
-            cv::Rect boundingRect = cv::boundingRect(objects[i].candidatePoints);
+			// draw uid above object
+            cv::Rect boundingRect = objects[i].rect;
             if(boundingRect.width < 1 || boundingRect.height < 1) { continue; }
-            cv::putText(*matRender, std::to_string(objects[i].confidence), cv::Point(boundingRect.x, boundingRect.y - 8), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+            renderLayer->drawText(objects[i].uid, cv::Point(boundingRect.x, boundingRect.y - 8), 0.5, cv::Scalar(255, 255, 255), 1);
 		}
 
-		// show candidate and object count in matRender
-        cv::putText(*matRender, "Candidates: " + std::to_string(candidates.size()), cv::Point(30, 80), cv::FONT_HERSHEY_SIMPLEX, 0.75, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
-        cv::putText(*matRender, "Objects: " + std::to_string(countObjects), cv::Point(30, 110), cv::FONT_HERSHEY_SIMPLEX, 0.75, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+		// show candidate and object count in render layer
+        renderLayer->drawText("Candidates: " + std::to_string(candidates.size()), cv::Point(30, 80), 0.75, cv::Scalar(255, 255, 255), 1);
+        renderLayer->drawText("Objects: " + std::to_string(countObjects), cv::Point(30, 110), 0.75, cv::Scalar(255, 255, 255), 1);
 	}
 
 
@@ -257,7 +554,7 @@
 
 		// draw contours
 		// for(int i = 0; i < (int) validContours.size(); i++) {
-		// 	cv::drawContours(*matRender, validContours, i, cv::Scalar(0, 0, 255), 1);
+		// 	renderLayer->drawPolygon(validContours[i], cv::Scalar(0, 0, 255), 1);
 		// }
 	}
 
@@ -280,6 +577,31 @@
 		}
 		else if(key == "project_id") {
 			projectId = value.toString();
+			sceneDiff->resync();
+			needsRequest = true;
+		}
+		else if(key == "project") {
+			std::lock_guard<std::mutex> lock(paletteMutex);
+			pendingProject = value.toJsonObject();
+			hasPendingProject = true;
+		}
+		else if(key == "track_spawn") {
+			trackSpawn = value.toInt();
+		}
+		else if(key == "track_kill") {
+			trackKill = value.toInt();
+		}
+		else if(key == "track_gate") {
+			trackGate = value.toInt();
+		}
+		else if(key == "color_interval") {
+			colorInterval = value.toInt();
+		}
+		else if(key == "scene_interval") {
+			sceneInterval = value.toInt();
+		}
+		else if(key == "scene_tolerance") {
+			sceneDiff->tolerance = value.toFloat();
 		}
 	}
 
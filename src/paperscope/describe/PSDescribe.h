@@ -7,6 +7,10 @@
 
 	#pragma once
 
+	// C++
+	#include <atomic>
+	#include <mutex>
+
 	// Qt
 	#include <QObject>
 	#include <QJsonObject>
@@ -20,6 +24,10 @@
 	#include "../detect/PSCandidate.h"
 	#include "../detect/PSShapeType.h"
 	#include "PSObject.h"
+	#include "PSSpatialGrid.h"
+	#include "PSColorPalette.h"
+	#include "PSSceneDiff.h"
+	#include "../PSRenderLayer.h"
 	#include "../../global/Settings.h"
 	#include "../../ui/renderer/RenderMode.h"
 
@@ -43,33 +51,74 @@ class PSDescribe : public QObject {
 
 		// processing
 		void init();
-		void update(cv::Mat *mTracking, cv::Mat *mRender, cv::Mat *mStreets, PSTrackingMode trackingMode, std::vector<PSCandidate> &candidates);
+		void update(cv::Mat *mTracking, PSRenderLayer *layer, cv::Mat *mStreets, PSTrackingMode trackingMode, std::vector<PSCandidate> &candidates);
 		void close();
 
 		// opencv
 		cv::Mat *matTracking;
-		cv::Mat *matRender;
+		PSRenderLayer *renderLayer;
 		cv::Mat *matStreets;
 
 		// server
-		void onRequestSent();
+		void onRequestSent(QJsonObject data);
+		void onRequestFailed(QString message, int code, QString url);
 
 
 	private:
 
 		// scene
 		void updateScene(std::vector<PSCandidate> &candidates);
+		int addObject(PSObject object);
+		void removeObject(int slot);
 		std::vector<PSObject> objects;
+		std::vector<int> freeSlots;
+		qint64 nextId;
+
+		// color
+		void updateColors();
+		cv::Mat colorHsv;
+		cv::Mat colorMask;
+		int colorInterval;
+		PSColorPalette *palette;
+
+		// palette changes arrive on the main thread
+		void updatePalette();
+		std::mutex paletteMutex;
+		QJsonObject pendingProject;
+		bool hasPendingProject;
+
+		// tracking
+		int trackSpawn;
+		int trackKill;
+		float trackGate;
+
+		// association
+		struct Geometry {
+			std::vector<cv::Point> points;
+			cv::Rect rect;
+			cv::Point center;
+		};
+		struct Match {
+			int candidate;
+			int slot;
+			float cost;
+		};
+		std::vector<int> assignMatches(std::vector<Match> &matches, int candidateCount);
+		std::vector<int> solveAssignment(std::vector<std::vector<float>> &costs);
+		PSSpatialGrid grid;
 
 		// streets
 		void updateStreets();
 
 		// server
 		void sendRequest();
-		bool needsRequest;
+		std::atomic<bool> needsRequest;
 		qint64 timestampSent;
-		bool isSending;
+		std::atomic<bool> isSending;
+		std::atomic<bool> isDeltaSupported;
 		QString projectId;
+		int sceneInterval;
+		PSSceneDiff *sceneDiff;
 
 		// renderer
 		void drawScene(std::vector<PSCandidate> &candidates);
@@ -9,7 +9,6 @@
 
 	// Qt
 	#include <QDebug>
-	#include <QRandomGenerator>
 
 
 
@@ -20,20 +19,58 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	PSObject::PSObject(std::vector<cv::Point> candidatePoints, PSShapeType shapeType, cv::Mat *matTracking, cv::Mat *matRender)
-		: candidatePoints(candidatePoints), 
-		  shapeType(shapeType),
+	PSObject::PSObject(std::vector<cv::Point> candidatePoints, PSShapeType shapeType, cv::Mat *matTracking, PSRenderLayer *renderLayer)
+		: shapeType(shapeType),
 		  matTracking(matTracking),
-          matRender(matRender)
+          renderLayer(renderLayer)
 	{
 
         // init properties
         colorIndex = 0;
+		colorAge = 0;
+		hasColor = false;
+		setPoints(candidatePoints);
+
+		// tentative until it was seen on enough frames
+		position = center;
+		velocity = cv::Point2f(0, 0);
+		hits = 1;
+		misses = 0;
+		shapeMisses = 0;
+		isConfirmed = false;
+		isActive = true;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	POINTS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
 
-        // set random uid as string
-		uid = QString::number(QRandomGenerator::global()->bounded(100000,999999)).toStdString();
+	/**
+	 * Points in plane coordinates, normalized points for the server and their bounds. Returns true if the
+	 * number of points changed or a point moved.
+	 */
+
+	bool PSObject::setPoints(std::vector<cv::Point> newPoints) {
+
+		// color of the new geometry on the next update, a vertex jittering by one pixel keeps the color
+		bool isMoved = newPoints.size() != candidatePoints.size();
+		bool isReshaped = isMoved;
+		for(size_t i = 0; i < newPoints.size() && !isReshaped; i++) {
+			cv::Point delta = newPoints[i] - candidatePoints[i];
+			if(delta != cv::Point(0, 0)) { isMoved = true; }
+			if(std::abs(delta.x) > 1 || std::abs(delta.y) > 1) { isReshaped = true; }
+		}
+		if(isReshaped) { colorAge = -1; }
+
+		candidatePoints = newPoints;
 
 		// normalize points
+		points.clear();
 		for(cv::Point &p : candidatePoints) {
 			cv::Point2f point;
 			point.x = (float) p.x / (float) matTracking->cols;
@@ -41,10 +78,13 @@
 			points.push_back(point);
 		}
 
-		confidence = 4;
-	}	
+		rect = cv::boundingRect(candidatePoints);
+		center = cv::Point(rect.x + rect.width / 2, rect.y + rect.height / 2);
+
+		return isMoved;
+	}
+
 
- 
 
 /*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -53,32 +93,91 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	bool PSObject::isSame(std::vector<cv::Point> targetPoints, PSShapeType targetShape) {
+	/**
+	 * Constant velocity prediction, called once per frame before matching.
+	 */
 
-		cv::Rect rect = cv::boundingRect(candidatePoints);
-		cv::Rect rectTarget = cv::boundingRect(targetPoints);
+	void PSObject::predict() {
+
+		position += velocity;
+	}
+
+
+	/**
+	 * True if the target is at the predicted place of the object, close to the predicted center or overlapping
+	 * the predicted bounding box. The cost is the distance to the prediction, a different shape costs 10 more.
+	 */
+
+	bool PSObject::matches(cv::Rect targetRect, cv::Point targetCenter, PSShapeType targetShape, float gate, float &cost) {
+
+		float distance = cv::norm(position - cv::Point2f(targetCenter));
+		cost = distance + (shapeType != targetShape ? 10.0f : 0.0f);
 
 		// same center
-		cv::Point center = cv::Point(rect.x + rect.width / 2, rect.y + rect.height / 2);
-		cv::Point centerTarget = cv::Point(rectTarget.x + rectTarget.width / 2, rectTarget.y + rectTarget.height / 2);
-		float distance = cv::norm(center - centerTarget);
-		if(distance < 10) { 
-			confidence += shapeType != targetShape ? 2 : 8;
-			if(confidence > 100) { confidence = 100; }
-			return true;
-		}
+		if(distance < gate) { return true; }
 
 		// overlapping bounding boxes
 		if(targetShape == PSShapeType::Street || shapeType == PSShapeType::Street) { return false; }
-		cv::Rect intersection = rect & rectTarget;
+		cv::Rect intersection = getPredictedRect() & targetRect;
 		float overlap = (float) intersection.area() / (float) rect.area();
-		if(overlap > 0.5) { 
-			confidence += shapeType != targetShape ? 2 : 8;
-			if(confidence > 100) { confidence = 100; }
+
+		return overlap > 0.5;
+	}
+
+
+	/**
+	 * Correct the prediction with the matched candidate. Points always follow the candidate, PSSceneDiff
+	 * decides which changes are sent. A different shape is taken over after spawnHits frames. Returns true
+	 * if a confirmed object changed, or if the object was confirmed on this frame.
+	 */
+
+	bool PSObject::update(std::vector<cv::Point> targetPoints, PSShapeType targetShape, int spawnHits) {
+
+		cv::Rect targetRect = cv::boundingRect(targetPoints);
+		cv::Point2f measured(targetRect.x + targetRect.width / 2, targetRect.y + targetRect.height / 2);
+
+		// velocity from the last corrected position, smoothed over frames
+		cv::Point2f previous = position - velocity;
+		velocity = 0.5f * velocity + 0.5f * (measured - previous);
+		position = measured;
+
+		hits++;
+		misses = 0;
+
+		bool isChanged = setPoints(targetPoints);
+
+		// shape hysteresis
+		shapeMisses = targetShape != shapeType ? shapeMisses + 1 : 0;
+		if(shapeMisses >= spawnHits) {
+			shapeType = targetShape;
+			shapeMisses = 0;
+			isChanged = true;
+		}
+
+		if(!isConfirmed && hits >= spawnHits) {
+			isConfirmed = true;
 			return true;
 		}
 
-		return false;
+		return isConfirmed && isChanged;
+	}
+
+
+	/**
+	 * No candidate on this frame, the object keeps moving with a damped velocity.
+	 */
+
+	void PSObject::miss() {
+
+		velocity *= 0.5f;
+		misses++;
+	}
+
+
+	cv::Rect PSObject::getPredictedRect() {
+
+		cv::Point offset(cvRound(position.x) - center.x, cvRound(position.y) - center.y);
+		return rect + offset;
 	}
 
 
@@ -95,18 +194,18 @@
 		if(shapeType != PSShapeType::Cross) {
 			
 			cv::Scalar color = this->shapeType == PSShapeType::Street ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
-			cv::drawContours(*matRender, std::vector<std::vector<cv::Point>>{candidatePoints}, -1, color, 1);
+			renderLayer->drawPolygon(candidatePoints, color, 1);
 			
 			// draw vertex points
 			if(shapeType != PSShapeType::Street) {
 				for(size_t i = 0; i < candidatePoints.size(); i++) { 
-					cv::circle(*matRender, candidatePoints[i], 5, cv::Scalar(0, 255, 255), -1); 
+					renderLayer->drawCircle(candidatePoints[i], 5, cv::Scalar(0, 255, 255), -1); 
 				}
 			}
 		}
 		// render cross as point
 		else {
-			cv::circle(*matRender, candidatePoints[0], 5, cv::Scalar(0, 255, 255), -1);
+			renderLayer->drawCircle(candidatePoints[0], 5, cv::Scalar(0, 255, 255), -1);
 		}
 
 		drawColor();
@@ -121,106 +220,69 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	void PSObject::detectColor() {
+	/**
+	 * True if the geometry changed since the last color or the color is older than interval frames.
+	 */
 
-        if(shapeType == PSShapeType::Street) { return; }
+	bool PSObject::needsColor(int interval) {
 
-		// get roi of object from matTracking
-		cv::Rect rect = cv::boundingRect(candidatePoints);
-        if(rect.width < 1 || rect.height < 1 || rect.x < 0 || rect.y < 0) { return; }
-        if(rect.x + rect.width > matTracking->cols || rect.y + rect.height > matTracking->rows) { return; }
-		cv::Mat roi = (*matTracking)(rect);
+		if(shapeType == PSShapeType::Street) { return false; }
+		if(colorAge < 0) { return true; }
 
-		// every pixel outside of candidatePoints shape should be black
-		cv::Mat mask = cv::Mat::zeros(roi.size(), CV_8UC1);
-		std::vector<std::vector<cv::Point>> contours = {candidatePoints};
-		cv::drawContours(mask, contours, 0, cv::Scalar(255), -1);
-		cv::bitwise_and(roi, roi, roi, mask);
-		
-		// convert to hsv
-		cv::cvtColor(roi, roi, cv::COLOR_BGR2HSV);
-
-		// get average color but ignore black pixels
-		int h = 0, s = 0, v = 0, count = 0;
-		for(int i = 0; i < roi.rows; i++) {
-			for(int j = 0; j < roi.cols; j++) {
-
-				int hue = roi.at<cv::Vec3b>(i, j)[0];
-				int sat = roi.at<cv::Vec3b>(i, j)[1];
-				int val = roi.at<cv::Vec3b>(i, j)[2];
-				
-				if(val > 30 && sat > 30) {
-					h += hue;
-					s += sat;
-					v += val;
-					count++;
-				}
-			}
-		}
-
-		// calculate average color
-		if(count > 0) { h /= count; s /= count; v /= count; }
-		avgColor = cv::Scalar(h,s,v);
-
-		// find best matching color
-		std::vector< std::vector<cv::Scalar> > colorCandidates = getColorCandidates();
-		float minDistance = 1000;
-		for(int i = 0; i < (int) colorCandidates.size(); i++) {
-
-			for(int j = 0; j < (int) colorCandidates[i].size(); j++) {
-				float distance = cv::norm(avgColor - colorCandidates[i][j]);
-				if(distance < minDistance) {
-					minDistance = distance;
-					colorIndex = i;
-				}
-			}
-		}
-    }
-
-
-	std::vector< std::vector<cv::Scalar> > PSObject::getColorCandidates() {
+		colorAge++;
+		return interval > 0 && colorAge >= interval;
+	}
 
-		std::vector< std::vector<cv::Scalar> > colorCandidates;
 
-		// [0] black
-		colorCandidates.push_back({
-			cv::Scalar(90, 20, 20), 
-		});
+	/**
+	 * Average BGR color inside the object, pixels that are dark or without saturation are ignored. hsv and
+	 * mask are scratch buffers shared by all objects, matTracking is not modified. The average is smoothed
+	 * over the updates of the track and looked up in the palette. Returns true if the color index changed.
+	 */
 
-		// [1] blue
-		colorCandidates.push_back({
-			cv::Scalar(110, 165 , 128)
-		});
+	bool PSObject::detectColor(cv::Mat &hsv, cv::Mat &mask, PSColorPalette *palette) {
 
-		// [2] green
-		colorCandidates.push_back({
-			cv::Scalar(75, 153, 128)
-		});
+		colorAge = 0;
 
-		// [3] yellow
-		colorCandidates.push_back({
-			cv::Scalar(43, 140, 235), 
-			cv::Scalar(25, 153, 155), 
-		});
+		// get roi of object from matTracking
+        if(rect.width < 1 || rect.height < 1 || rect.x < 0 || rect.y < 0) { return false; }
+        if(rect.x + rect.width > matTracking->cols || rect.y + rect.height > matTracking->rows) { return false; }
+		cv::Mat roi = (*matTracking)(rect);
+		cv::cvtColor(roi, hsv, cv::COLOR_BGR2HSV);
 
-		return colorCandidates;
-	}
+		// pixels inside of candidatePoints with enough saturation and value
+		mask.create(rect.size(), CV_8UC1);
+		mask.setTo(cv::Scalar(0));
+		std::vector<std::vector<cv::Point>> contours = {candidatePoints};
+		cv::fillPoly(mask, contours, cv::Scalar(255), cv::LINE_8, 0, -rect.tl());
+		cv::Mat valid;
+		cv::inRange(hsv, cv::Scalar(0, 31, 31), cv::Scalar(255, 255, 255), valid);
+		cv::bitwise_and(mask, valid, mask);
+
+		// masked average, smoothed per track
+		cv::Scalar color = cv::countNonZero(mask) > 0 ? cv::mean(roi, mask) : cv::Scalar(0, 0, 0);
+		avgColor = hasColor ? 0.5 * avgColor + 0.5 * color : color;
+		hasColor = true;
+
+		// closest palette color
+		int previousIndex = colorIndex;
+		colorIndex = palette->classify(avgColor);
+		colorName = palette->getName(colorIndex);
+
+		return colorIndex != previousIndex;
+    }
 
 
 	void PSObject::drawColor() {
 
 		if(shapeType == PSShapeType::Street) { return; }
 
-		cv::Rect rect = cv::boundingRect(candidatePoints);
         if(rect.width < 1 || rect.height < 1) { return; }
 
 		// render color as circle
-		cv::Mat rgbColor;
-		cv::cvtColor(cv::Mat(1, 1, CV_8UC3, avgColor), rgbColor, cv::COLOR_HSV2BGR);
-		cv::circle(*matRender, cv::Point(rect.x, rect.y + rect.height + 20), 10, cv::Scalar(rgbColor.at<cv::Vec3b>(0, 0)[0], rgbColor.at<cv::Vec3b>(0, 0)[1], rgbColor.at<cv::Vec3b>(0, 0)[2]), -1);
+		renderLayer->drawCircle(cv::Point(rect.x, rect.y + rect.height + 20), 10, avgColor, -1);
 
 		// render color name
-		std::vector<std::string> colorNames = {"black", "blue", "green", "yellow"};
-		cv::putText(*matRender, colorNames[colorIndex], cv::Point(rect.x + 16, rect.y + rect.height + 25), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1, cv::LINE_AA);
+		renderLayer->drawText(colorName, cv::Point(rect.x + 16, rect.y + rect.height + 25), 0.5, cv::Scalar(255, 255, 255), 1);
 	}
 
@@ -12,6 +12,8 @@
 
 	// App
 	#include "../detect/PSShapeType.h"
+	#include "../PSRenderLayer.h"
+	#include "PSColorPalette.h"
 
 
 
@@ -27,16 +29,29 @@ class PSObject {
 	
 	public:
 		
-		PSObject(std::vector<cv::Point> candidatePoints, PSShapeType shapeType, cv::Mat *matTracking, cv::Mat *matRender);
+		PSObject(std::vector<cv::Point> candidatePoints, PSShapeType shapeType, cv::Mat *matTracking, PSRenderLayer *renderLayer);
 
 		// properties
 		std::string uid;
 		std::vector<cv::Point> candidatePoints;
 		std::vector<cv::Point2f> points;
+		bool setPoints(std::vector<cv::Point> newPoints);
+		cv::Rect rect;
+		cv::Point center;
 
 		// tracking
-		bool isSame(std::vector<cv::Point> targetPoints, PSShapeType targetShape);
-		int confidence;
+		void predict();
+		bool matches(cv::Rect targetRect, cv::Point targetCenter, PSShapeType targetShape, float gate, float &cost);
+		bool update(std::vector<cv::Point> targetPoints, PSShapeType targetShape, int spawnHits);
+		void miss();
+		cv::Rect getPredictedRect();
+		cv::Point2f position;
+		cv::Point2f velocity;
+		int hits;
+		int misses;
+		int shapeMisses;
+		bool isConfirmed;
+		bool isActive;
 
 		// contour
 		PSShapeType shapeType;
@@ -44,16 +59,19 @@ class PSObject {
 
 		// color detection
 		int colorIndex;
+		std::string colorName;
 		cv::Scalar avgColor;
-		void detectColor();
+		bool needsColor(int interval);
+		bool detectColor(cv::Mat &hsv, cv::Mat &mask, PSColorPalette *palette);
 		void drawColor();
-		std::vector< std::vector<cv::Scalar> > getColorCandidates();
+		int colorAge;
+		bool hasColor;
 
 	
 	private:
 
 		// paperscope
 		cv::Mat *matTracking;
-		cv::Mat *matRender;
+		PSRenderLayer *renderLayer;
 };
 
@@ -0,0 +1,183 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSSceneDiff.h"
+
+	// Qt
+	#include <QJsonArray>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSSceneDiff::PSSceneDiff()
+		: tolerance(0.002f),
+		  version(0),
+		  pendingVersion(0),
+		  nextVersion(1),
+		  needsResync(true),
+		  isPending(false)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	REQUESTS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Request data for the current scene, false if there is nothing to send. A full snapshot has a "scene"
+	 * array, a delta has "base" and the arrays "added", "changed" and "removed". An empty scene is never
+	 * sent as snapshot.
+	 */
+
+	bool PSSceneDiff::build(std::map<std::string, Entry> &scene, QJsonObject &data, bool &isFull) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		isFull = needsResync;
+
+		// full snapshot
+		if(isFull) {
+
+			if(scene.empty()) { return false; }
+
+			QJsonArray objects;
+			for(auto &[uid, entry] : scene) { objects.append(toJson(uid, entry)); }
+
+			pending = scene;
+			pendingVersion = nextVersion++;
+			isPending = true;
+			data["version"] = pendingVersion;
+			data["scene"] = objects;
+
+			return true;
+		}
+
+		// changes since the acknowledged scene
+		QJsonArray added, changed, removed;
+		std::map<std::string, Entry> next = acknowledged;
+		for(auto &[uid, entry] : scene) {
+			auto last = acknowledged.find(uid);
+			if(last == acknowledged.end()) {
+				added.append(toJson(uid, entry));
+				next[uid] = entry;
+			}
+			else if(isChanged(last->second, entry)) {
+				changed.append(toJson(uid, entry));
+				next[uid] = entry;
+			}
+		}
+		for(auto &[uid, entry] : acknowledged) {
+			if(scene.count(uid) == 0) {
+				removed.append(QString::fromStdString(uid));
+				next.erase(uid);
+			}
+		}
+
+		if(added.isEmpty() && changed.isEmpty() && removed.isEmpty()) { return false; }
+
+		pending = next;
+		pendingVersion = nextVersion++;
+		isPending = true;
+		data["version"] = pendingVersion;
+		data["base"] = version;
+		data["added"] = added;
+		data["changed"] = changed;
+		data["removed"] = removed;
+
+		return true;
+	}
+
+
+	/**
+	 * The last request was stored, its scene is the base of the next delta. Requests sent before a resync
+	 * are ignored.
+	 */
+
+	void PSSceneDiff::acknowledge() {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!isPending) { return; }
+		isPending = false;
+
+		acknowledged = pending;
+		version = pendingVersion;
+		needsResync = false;
+	}
+
+
+	/**
+	 * Send a full snapshot next, e.g. after a failed request or for another project.
+	 */
+
+	void PSSceneDiff::resync() {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		acknowledged.clear();
+		needsResync = true;
+		isPending = false;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	SCENES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Shape or color changed, or a point moved further than tolerance in normalized plane coordinates.
+	 */
+
+	bool PSSceneDiff::isChanged(const Entry &last, const Entry &current) {
+
+		if(last.shape != current.shape || last.color != current.color) { return true; }
+		if(last.points.size() != current.points.size()) { return true; }
+
+		for(size_t i = 0; i < last.points.size(); i++) {
+			if(cv::norm(last.points[i] - current.points[i]) > tolerance) { return true; }
+		}
+
+		return false;
+	}
+
+
+	QJsonObject PSSceneDiff::toJson(const std::string &uid, const Entry &entry) {
+
+		// default properties
+		QJsonObject obj;
+		obj["uid"] = uid.c_str();
+		obj["shape"] = entry.shape;
+		obj["color"] = entry.color;
+
+		// points data
+		QJsonArray points;
+		for(const cv::Point2f &point : entry.points) {
+			QJsonObject p;
+			p["x"] = point.x;
+			p["y"] = point.y;
+			points.append(p);
+		}
+		obj["points"] = points;
+
+		return obj;
+	}
@@ -0,0 +1,74 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <map>
+	#include <mutex>
+	#include <string>
+	#include <vector>
+
+	// Qt
+	#include <QJsonObject>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Differences between the scene on the server and the current scene. The last scene acknowledged by the
+ * server is kept, requests only carry the objects that were added, removed or changed by more than the
+ * tolerance since then. Every request has a new version and names the acknowledged version it is based
+ * on. A full snapshot is only sent on the first request and after the server asked for a resync.
+ */
+
+class PSSceneDiff {
+
+	public:
+
+		struct Entry {
+			int shape;
+			int color;
+			std::vector<cv::Point2f> points;
+		};
+
+		PSSceneDiff();
+
+		// requests
+		bool build(std::map<std::string, Entry> &scene, QJsonObject &data, bool &isFull);
+		void acknowledge();
+		void resync();
+
+		// settings
+		float tolerance;
+
+
+	private:
+
+		// scenes
+		bool isChanged(const Entry &last, const Entry &current);
+		QJsonObject toJson(const std::string &uid, const Entry &entry);
+		std::map<std::string, Entry> acknowledged;
+		std::map<std::string, Entry> pending;
+		int version;
+		int pendingVersion;
+		int nextVersion;
+		bool needsResync;
+		bool isPending;
+
+		// acknowledgements arrive on the main thread
+		std::mutex mutex;
+};
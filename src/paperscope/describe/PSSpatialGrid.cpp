@@ -0,0 +1,96 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSSpatialGrid.h"
+
+	// C++
+	#include <algorithm>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSSpatialGrid::PSSpatialGrid()
+		: cellSize(64),
+		  cols(0),
+		  rows(0)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	GRID
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Remove all ids, cells keep their memory for the next frame.
+	 */
+
+	void PSSpatialGrid::reset(cv::Size size) {
+
+		int newCols = std::max(1, (size.width + cellSize - 1) / cellSize);
+		int newRows = std::max(1, (size.height + cellSize - 1) / cellSize);
+		if(newCols != cols || newRows != rows) {
+			cols = newCols;
+			rows = newRows;
+			cells.assign(cols * rows, {});
+		}
+
+		for(std::vector<int> &cell : cells) { cell.clear(); }
+	}
+
+
+	void PSSpatialGrid::insert(int id, cv::Rect rect) {
+
+		cv::Rect range = cellRange(rect);
+		for(int y = range.y; y < range.y + range.height; y++) {
+			for(int x = range.x; x < range.x + range.width; x++) { cells[y * cols + x].push_back(id); }
+		}
+	}
+
+
+	void PSSpatialGrid::query(cv::Rect rect, std::vector<int> &ids) {
+
+		ids.clear();
+
+		cv::Rect range = cellRange(rect);
+		for(int y = range.y; y < range.y + range.height; y++) {
+			for(int x = range.x; x < range.x + range.width; x++) {
+				std::vector<int> &cell = cells[y * cols + x];
+				ids.insert(ids.end(), cell.begin(), cell.end());
+			}
+		}
+
+		// ids covering several cells
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	}
+
+
+	/**
+	 * Cells covered by rect, rects outside of the plane are clamped to the border cells.
+	 */
+
+	cv::Rect PSSpatialGrid::cellRange(cv::Rect rect) {
+
+		int x0 = std::clamp(rect.x / cellSize, 0, cols - 1);
+		int y0 = std::clamp(rect.y / cellSize, 0, rows - 1);
+		int x1 = std::clamp((rect.x + std::max(rect.width, 1) - 1) / cellSize, 0, cols - 1);
+		int y1 = std::clamp((rect.y + std::max(rect.height, 1) - 1) / cellSize, 0, rows - 1);
+
+		return cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+	}
@@ -0,0 +1,53 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Uniform grid over the table plane. Ids are inserted into every cell their rect covers, a query returns
+ * each id stored in the cells of a rect once. Lookups only touch the neighbourhood of the rect instead of
+ * all objects of the scene.
+ */
+
+class PSSpatialGrid {
+
+	public:
+
+		PSSpatialGrid();
+
+		// grid
+		void reset(cv::Size size);
+		void insert(int id, cv::Rect rect);
+		void query(cv::Rect rect, std::vector<int> &ids);
+
+		// settings
+		int cellSize;
+
+
+	private:
+
+		// cells
+		cv::Rect cellRange(cv::Rect rect);
+		std::vector<std::vector<int>> cells;
+		int cols;
+		int rows;
+};
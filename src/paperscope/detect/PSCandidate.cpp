@@ -18,7 +18,8 @@
 
 	PSCandidate::PSCandidate(std::vector<cv::Point> contour, PSShapeType shapeType)
 		: contour(contour),
-		  shapeType(shapeType)
+		  shapeType(shapeType),
+		  isProvisional(false)
 	{
 
 	}
@@ -80,18 +81,18 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
-	void PSCandidate::drawBoundingBox(cv::Mat *matRender) {
+	void PSCandidate::drawBoundingBox(PSRenderLayer *renderLayer) {
 
 		cv::Scalar color = this->shapeType == PSShapeType::Street ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
 
 		cv::Rect rect = cv::boundingRect(contour);
-		cv::rectangle(*matRender, rect, color);
+		renderLayer->drawRect(rect, color);
 
-		drawShapeType(matRender);
+		drawShapeType(renderLayer);
 	}
 
 
-	void PSCandidate::drawShapeType(cv::Mat *matRender) {
+	void PSCandidate::drawShapeType(PSRenderLayer *renderLayer) {
 
 		std::string label;
 		cv::Scalar color = this->shapeType == PSShapeType::Street ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
@@ -107,5 +108,5 @@
 
 		// draw label
 		cv::Rect rect = cv::boundingRect(contour);
-		cv::putText(*matRender, label, cv::Point(rect.x, rect.y - 10.0), cv::FONT_HERSHEY_SIMPLEX, 0.75, color, 2, cv::LINE_AA);
+		renderLayer->drawText(label, cv::Point(rect.x, rect.y - 10.0), 0.75, color, 2);
 	}
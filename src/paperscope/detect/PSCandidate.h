@@ -12,6 +12,7 @@
 
 	// App
 	#include "PSShapeType.h"
+	#include "../PSRenderLayer.h"
 
 
 
@@ -35,9 +36,10 @@ class PSCandidate {
 		// contour
 		std::vector<cv::Point> contour;
 		PSShapeType shapeType;
+		bool isProvisional;
 		
 		// draw
-		void drawBoundingBox(cv::Mat *matRender);
-		void drawShapeType(cv::Mat *matRender);
+		void drawBoundingBox(PSRenderLayer *renderLayer);
+		void drawShapeType(PSRenderLayer *renderLayer);
 };
 
@@ -0,0 +1,113 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSChangeDetector.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSChangeDetector::PSChangeDetector()
+		: tileSize(64),
+		  threshold(20),
+		  tileCount(0)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CHANGES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Dirty tiles of image in image coordinates. isReset is set if there is no reference to compare with,
+	 * on the first frame, after a size change or reset and while disabled. The whole image is dirty then.
+	 */
+
+	std::vector<cv::Rect> PSChangeDetector::update(cv::Mat &image, bool &isReset) {
+
+		std::vector<cv::Rect> tiles;
+		isReset = true;
+		if(image.empty()) { return tiles; }
+
+		// gray samples at quarter resolution
+		cv::Mat samples;
+		cv::Size size(std::max(1, image.cols / sampling), std::max(1, image.rows / sampling));
+		cv::resize(image, samples, size, 0, 0, cv::INTER_AREA);
+		if(samples.channels() == 3) { cv::cvtColor(samples, samples, cv::COLOR_BGR2GRAY); }
+
+		int step = std::max(1, tileSize / sampling);
+		int cols = (size.width + step - 1) / step;
+		int rows = (size.height + step - 1) / step;
+		tileCount = cols * rows;
+
+		// new plane
+		if(reference.empty() || imageSize != image.size() || !isEnabled()) {
+			reference = samples;
+			imageSize = image.size();
+			tiles.push_back(cv::Rect(0, 0, image.cols, image.rows));
+			return tiles;
+		}
+		isReset = false;
+
+		cv::Mat diff;
+		cv::absdiff(samples, reference, diff);
+
+		for(int y = 0; y < rows; y++) {
+			for(int x = 0; x < cols; x++) {
+
+				cv::Rect cell = cv::Rect(x * step, y * step, step, step) & cv::Rect(0, 0, size.width, size.height);
+
+				double maxDiff;
+				cv::minMaxLoc(diff(cell), nullptr, &maxDiff);
+				if(maxDiff <= threshold) { continue; }
+
+				samples(cell).copyTo(reference(cell));
+
+				// last row and column cover the remainder of the image
+				cv::Point tl(cell.x * sampling, cell.y * sampling);
+				cv::Point br(cell.br().x * sampling, cell.br().y * sampling);
+				if(cell.br().x == size.width) { br.x = image.cols; }
+				if(cell.br().y == size.height) { br.y = image.rows; }
+				tiles.push_back(cv::Rect(tl, br));
+			}
+		}
+
+		return tiles;
+	}
+
+
+	void PSChangeDetector::reset() {
+
+		reference = cv::Mat();
+	}
+
+
+	/**
+	 * A threshold of 0 disables change detection, every frame is fully dirty.
+	 */
+
+	bool PSChangeDetector::isEnabled() {
+
+		return threshold > 0;
+	}
+
+
+	int PSChangeDetector::getTileCount() {
+
+		return tileCount;
+	}
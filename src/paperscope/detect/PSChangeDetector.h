@@ -0,0 +1,55 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Finds the tiles of the table plane that changed since they were last processed. Frames are compared at
+ * quarter resolution in gray, a tile is dirty if any sample differs more than threshold from the reference.
+ * Dirty tiles take over the current samples, so slow drifts are picked up once they pass the threshold.
+ */
+
+class PSChangeDetector {
+
+	public:
+
+		PSChangeDetector();
+
+		// changes
+		std::vector<cv::Rect> update(cv::Mat &image, bool &isReset);
+		void reset();
+		bool isEnabled();
+		int getTileCount();
+
+		// settings
+		int tileSize;
+		int threshold;
+
+
+	private:
+
+		// reference
+		static const int sampling = 4;
+		cv::Mat reference;
+		cv::Size imageSize;
+		int tileCount;
+};
@@ -0,0 +1,180 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSColorTable.h"
+
+	// C++
+	#include <algorithm>
+	#include <atomic>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSColorTable::PSColorTable()
+		: table(nullptr),
+		  classifier(nullptr),
+		  hasRequest(false),
+		  isStopping(false),
+		  requestDark(0),
+		  requestLight(0),
+		  requestRed(0)
+	{
+
+		classifier = new PSPixelClassifier();
+		worker = std::thread([this]() { buildTables(); });
+	}
+
+
+	PSColorTable::~PSColorTable() {
+
+		{
+			std::lock_guard<std::mutex> lock(requestMutex);
+			isStopping = true;
+		}
+		requestCondition.notify_all();
+		worker.join();
+
+		delete classifier;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TABLE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Schedule a rebuild for new thresholds. Requests arriving during a build are merged, only the latest
+	 * thresholds are built next.
+	 */
+
+	void PSColorTable::request(int dark, int light, int red) {
+
+		{
+			std::lock_guard<std::mutex> lock(requestMutex);
+			requestDark = dark;
+			requestLight = light;
+			requestRed = red;
+			hasRequest = true;
+		}
+		requestCondition.notify_one();
+	}
+
+
+	/**
+	 * Returns false if no table for these thresholds is available yet, the caller classifies the pixels
+	 * itself until the rebuild is done.
+	 */
+
+	bool PSColorTable::classify(cv::Mat image, cv::Mat &value, cv::Mat &streets, int dark, int light, int red) {
+
+		std::shared_ptr<const Table> current = std::atomic_load(&table);
+		if(!current || current->thresholdDark != dark || current->thresholdLight != light || current->thresholdRed != red) {
+			return false;
+		}
+
+		CV_Assert(image.type() == CV_8UC3);
+
+		value.create(image.size(), CV_8UC1);
+		streets.create(image.size(), CV_8UC1);
+
+		const uchar *codes = current->codes.data();
+		for(int i = 0; i < image.rows; i++) {
+
+			const uchar *bgr = image.ptr<uchar>(i);
+			uchar *rowValue = value.ptr<uchar>(i);
+			uchar *rowStreets = streets.ptr<uchar>(i);
+
+			for(int j = 0; j < image.cols; j++, bgr += 3) {
+				uchar code = codes[((bgr[0] >> 2) << 12) | ((bgr[1] >> 2) << 6) | (bgr[2] >> 2)];
+				uchar inv = 255 - std::max(bgr[0], std::max(bgr[1], bgr[2]));
+				rowValue[j] = code == Keep ? inv : code == Full ? 255 : 0;
+				rowStreets[j] = code == Street ? 255 : 0;
+			}
+		}
+
+		return true;
+	}
+
+
+	/**
+	 * Classify the centre colour of every 4x4x4 bin, the bins are laid out as an image with one row per
+	 * blue/green pair so the vectorized classifier can be reused.
+	 */
+
+	std::shared_ptr<const PSColorTable::Table> PSColorTable::build(int dark, int light, int red) {
+
+		cv::Mat centres(64 * 64, 64, CV_8UC3);
+		for(int i = 0; i < centres.rows; i++) {
+			for(int j = 0; j < centres.cols; j++) {
+				centres.at<cv::Vec3b>(i, j) = cv::Vec3b((i >> 6) * 4 + 2, (i & 63) * 4 + 2, j * 4 + 2);
+			}
+		}
+
+		cv::Mat value, streets;
+		classifier->setThresholds(dark, light, red);
+		classifier->classify(centres, value, streets);
+
+		std::shared_ptr<Table> result = std::make_shared<Table>();
+		result->thresholdDark = dark;
+		result->thresholdLight = light;
+		result->thresholdRed = red;
+		result->codes.resize(64 * 64 * 64);
+
+		for(int i = 0; i < centres.rows; i++) {
+			for(int j = 0; j < centres.cols; j++) {
+
+				cv::Vec3b bgr = centres.at<cv::Vec3b>(i, j);
+				uchar inv = 255 - std::max(bgr[0], std::max(bgr[1], bgr[2]));
+				uchar out = value.at<uchar>(i, j);
+
+				uchar &code = result->codes[(i << 6) | j];
+				if(streets.at<uchar>(i, j)) { code = Street; }
+				else if(out == inv) { code = Keep; }
+				else if(out == 0) { code = Zero; }
+				else { code = Full; }
+			}
+		}
+
+		return result;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	WORKER
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSColorTable::buildTables() {
+
+		while(true) {
+
+			std::unique_lock<std::mutex> lock(requestMutex);
+			requestCondition.wait(lock, [this]() { return isStopping || hasRequest; });
+			if(isStopping) { return; }
+
+			int dark = requestDark;
+			int light = requestLight;
+			int red = requestRed;
+			hasRequest = false;
+			lock.unlock();
+
+			std::atomic_store(&table, build(dark, light, red));
+		}
+	}
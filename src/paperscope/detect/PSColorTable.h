@@ -0,0 +1,79 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <condition_variable>
+	#include <memory>
+	#include <mutex>
+	#include <thread>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSPixelClassifier.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Lookup table from quantized BGR colours to the pixel classes of PSPixelClassifier. The classes only
+ * depend on the thresholds, the table is rebuilt on a worker thread when they change and swapped in
+ * atomically. Only the class is quantized, the inverted value is still taken from the exact pixel.
+ */
+
+class PSColorTable {
+
+	public:
+
+		PSColorTable();
+		~PSColorTable();
+
+		// table
+		void request(int dark, int light, int red);
+		bool classify(cv::Mat image, cv::Mat &value, cv::Mat &streets, int dark, int light, int red);
+
+
+	private:
+
+		// table
+		enum Code : uchar {
+			Keep = 0,
+			Zero = 1,
+			Full = 2,
+			Street = 3
+		};
+		struct Table {
+			int thresholdDark;
+			int thresholdLight;
+			int thresholdRed;
+			std::vector<uchar> codes;
+		};
+		std::shared_ptr<const Table> build(int dark, int light, int red);
+		std::shared_ptr<const Table> table;
+		PSPixelClassifier *classifier;
+
+		// worker
+		void buildTables();
+		std::thread worker;
+		std::mutex requestMutex;
+		std::condition_variable requestCondition;
+		bool hasRequest;
+		bool isStopping;
+		int requestDark;
+		int requestLight;
+		int requestRed;
+};
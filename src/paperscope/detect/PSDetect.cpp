@@ -13,16 +13,15 @@
 	#include <QRandomGenerator>
 	#include <QDir>
 	#include <QStandardPaths>
+	#include <QThread>
 
 	// OpenCV
 	#include <opencv2/xphoto/white_balance.hpp>
 	#include <opencv2/ximgproc.hpp>
-	
-	// Tensorflow
-	#include "tensorflow/lite/model.h"
-	#include "tensorflow/lite/tools/gen_op_registration.h"
 
 	// App
+	#include "../PSProfiler.h"
+	#include "../PSTaskGroup.h"
 	#include "../../global/Settings.h"
 
 
@@ -39,24 +38,55 @@
 		  matTracking(nullptr),
 		  matProcessing(nullptr),
 		  matThreshold(nullptr),
-		  matRender(nullptr),
+		  matCoarse(nullptr),
+		  matLocal(nullptr),
+		  renderLayer(nullptr),
+		  pixelClassifier(nullptr),
+		  colorTable(nullptr),
+		  localThreshold(nullptr),
+		  changeDetector(nullptr),
+		  hasResults(false),
 		  matStreets(nullptr),
-		  model(nullptr),
-		  resolver(nullptr),
-	 	  interpreter(nullptr)
+		  matStreetMask(nullptr),
+		  shapeClassifier(nullptr),
+		  shapeCache(nullptr)
 	{
 
 		// init properties
 		matProcessing = new cv::Mat();
 		matThreshold = new cv::Mat();
+		matCoarse = new cv::Mat();
+		matLocal = new cv::Mat();
 		matStreets = new cv::Mat();
+		matStreetMask = new cv::Mat();
+		pixelClassifier = new PSPixelClassifier();
+		pixelKernel = Settings::instance()->getString("pixel_kernel", "simd");
+		changeDetector = new PSChangeDetector();
+		changeDetector->threshold = Settings::instance()->getInt("change_threshold", 20);
+		changeDetector->tileSize = Settings::instance()->getInt("change_tile", 64);
 		thresholdDark = Settings::instance()->getInt("threshold_dark",50);
 		thresholdLight = Settings::instance()->getInt("threshold_light",180);
 		thresholdRed = Settings::instance()->getInt("threshold_red",150);
+		detectWidth = Settings::instance()->getInt("detect_width", 960);
+		detectTile = Settings::instance()->getInt("detect_tile", 0);
+		detectExtractor = Settings::instance()->getString("detect_extractor", "components");
+		localThreshold = new PSLocalThreshold();
+		localThreshold->windowSize = Settings::instance()->getInt("threshold_window", 41);
+		thresholdMethod = Settings::instance()->getString("threshold_method", "otsu");
+		localThreshold->method = thresholdMethod == "bradley" ? PSLocalThreshold::Method::Bradley : PSLocalThreshold::Method::Sauvola;
+		colorTable = new PSColorTable();
+		if(pixelKernel == "lut") { colorTable->request(thresholdDark, thresholdLight, thresholdRed); }
+		coarseScale = 1.0f;
 		renderMode = RenderMode::Camera,
 		viewMode = PSViewMode::Threshold;
 
 		// init member
+		shapeClassifier = new PSShapeClassifier();
+		shapeCache = new PSShapeCache();
+		isCacheEnabled = Settings::instance()->getBool("classifier_cache", true);
+		classifierBudget = Settings::instance()->getInt("classifier_budget", 32);
+		classifierQueue = Settings::instance()->getInt("classifier_queue", 64);
+		deferredShapes = 0;
 		initAI();
 	}
 
@@ -65,7 +95,16 @@
 
 		delete matProcessing;
 		delete matThreshold;
+		delete matCoarse;
+		delete matLocal;
 		delete matStreets;
+		delete matStreetMask;
+		delete pixelClassifier;
+		delete colorTable;
+		delete localThreshold;
+		delete changeDetector;
+		delete shapeClassifier;
+		delete shapeCache;
 	}
 
 
@@ -82,37 +121,97 @@
 	}
 
 
-	void PSDetect::update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode) {
+	void PSDetect::update(cv::Mat *mTracking, PSRenderLayer *layer, PSTrackingMode trackingMode) {
 
 		matTracking = mTracking;
-		matRender = mRender;
+		renderLayer = layer;
+		applySettings();
 
 		// skip loop
 		if(trackingMode == PSTrackingMode::None || matTracking->empty()) {
 			
 			if(renderMode == RenderMode::PaperScope) {
-				*matRender = cv::Mat::zeros(cv::Size(matRender->cols, matRender->rows), CV_8UC3);
+				renderLayer->clear(renderLayer->getSize());
 			}
+			hasResults = false;
 			return;
 		}
 
-		imageProcessing();
-		applyThreshold();
+		buildCoarseLevel();
+		pixelClassifier->setThresholds(thresholdDark, thresholdLight, thresholdRed);
+		bool isReset;
+		std::vector<cv::Rect> tiles = changeDetector->update(*matCoarse, isReset);
+
+		// static table reuses the last results, moved pieces only update their tiles
+		if(trackingMode == PSTrackingMode::Tracking && isIncremental(tiles, isReset)) {
+			if(tiles.empty()) {
+				PSProfiler::instance()->count("detect static");
+
+				// shapes deferred by the budget are classified on static frames too
+				if(deferredShapes > 0) {
+					classifyShapes();
+					joinCandidates();
+				}
+			}
+			else {
+				updateTiles(tiles);
+			}
+			drawThreshold();
+		}
+		else {
+			imageProcessing();
+			applyThreshold();
+			if(trackingMode == PSTrackingMode::Tracking) {
+
+				// streets only read the street mask, they are traced while the shapes are classified
+				PSTaskGroup tasks;
+				tasks.run([this]() { findStreets(); });
+				findContours();
+				tasks.wait();
+
+				joinCandidates();
+				hasResults = true;
+			}
+		}
 
 		if(trackingMode == PSTrackingMode::Tracking) {
 
-			findContours();
-			findStreets();
 			drawCandidates();
-
-			// prepare tracking mat for PSDescribe
-			cv::erode(*matThreshold, *matThreshold, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3)));
-			cv::cvtColor(*matThreshold, *matThreshold, cv::COLOR_GRAY2BGR);
-			cv::bitwise_and(*matTracking, *matThreshold, *matTracking);
+			maskTracking();
 		}
 	}
 
 
+	/**
+	 * Masked tracking mat for PSDescribe. Always a new buffer, threshold and plane may be the render base.
+	 */
+
+	void PSDetect::maskTracking() {
+
+		cv::Mat mask(matTracking->size(), CV_8UC3);
+		cv::Mat kernelErode = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+
+		std::vector<cv::Rect> tiles = { cv::Rect(0, 0, mask.cols, mask.rows) };
+		if(detectTile > 0) { tiles = splitTiles(mask.size()); }
+
+		cv::Rect bounds(0, 0, mask.cols, mask.rows);
+		cv::parallel_for_(cv::Range(0, (int) tiles.size()), [&](const cv::Range &range) {
+			for(int i = range.start; i < range.end; i++) {
+
+				// one pixel border for the erode kernel
+				cv::Rect padded = cv::Rect(tiles[i].x - 1, tiles[i].y - 1, tiles[i].width + 2, tiles[i].height + 2) & bounds;
+				cv::Mat eroded, bgr;
+				cv::erode((*matThreshold)(padded), eroded, kernelErode);
+				cv::cvtColor(eroded(tiles[i] - padded.tl()), bgr, cv::COLOR_GRAY2BGR);
+				cv::Mat target = mask(tiles[i]);
+				cv::bitwise_and((*matTracking)(tiles[i]), bgr, target);
+			}
+		});
+
+		*matTracking = mask;
+	}
+
+
 	void PSDetect::close() {
 
 	}
@@ -135,78 +234,69 @@
 		// white balance
 		//whiteBalance(*matTracking);
 
-		// convert rgb to hsv
-		cv::cvtColor(*matTracking, *matProcessing, cv::COLOR_BGR2HSV);
-
-		// split hsv channels
-		std::vector<cv::Mat> hsv;
-		cv::split(*matProcessing, hsv);
-		cv::Mat hue = hsv[0];
-		cv::Mat saturation = hsv[1];
-		cv::Mat value = hsv[2];
-		
-		// streets are detected by red pixels
-		matStreets->create(value.size(), CV_8UC1);
-		matStreets->setTo(cv::Scalar(0));
-		
-		// optimize vue channel
-		cv::bitwise_not(value, value); // invert image for better thresholding
-		for(int i = 0; i < value.rows; i++) {
-			for(int j = 0; j < value.cols; j++) {
-				
-				// hsv values
-				int valHue = hue.at<uchar>(i, j);
-				int valSat = saturation.at<uchar>(i, j);
-				int valVal = value.at<uchar>(i, j);
-				
-				// rgb values
-				int r = (*matTracking).at<cv::Vec3b>(i, j)[2];
-				int g = (*matTracking).at<cv::Vec3b>(i, j)[1];
-				int b = (*matTracking).at<cv::Vec3b>(i, j)[0];
-
-				// extract red pixels for streets
-				float range = thresholdRed/255.0 * 50;
-				bool isRed = r > 50 && (valHue < range || valHue > 180 - range) && valVal > 50 && valSat > 50;
-				if(isRed) { 
-					matStreets->at<uchar>(i, j) = 255; 
-					value.at<uchar>(i, j) = 0;
-				}
-
-				// remove gray pixels
-				else if(r > 150 && abs(r - g) < 10 &&abs(g - b) < 20) { value.at<uchar>(i, j) = 0; }
-				// remove dark pixels
-				else if(valVal < thresholdDark && valSat < thresholdDark) { value.at<uchar>(i, j) = 0; }
-				// add light pixels
-				else if(valVal > thresholdLight) { value.at<uchar>(i, j) = 255; }
-				// prefer saturation if higher than value
-				else if(valSat > valVal && valSat > 70 && valVal > 60) { value.at<uchar>(i, j) = 255; }
-			}
+		cv::Mat value;
+		if(detectTile > 0) {
+			value.create(matCoarse->size(), CV_8UC1);
+			matStreetMask->create(matCoarse->size(), CV_8UC1);
+			processTiles(splitTiles(matCoarse->size()), value, *matStreetMask);
+		}
+		else {
+			processPixels(*matCoarse, value, *matStreetMask, 1.0f);
 		}
-
-		// optimize streets channel and remove red pixels from value channel
-		cv::Mat kernelDilate = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5,5));
-		cv::medianBlur(*matStreets, *matStreets, 3);
-		cv::dilate(*matStreets, *matStreets, kernelDilate);
-		cv::subtract(value, *matStreets, value);
 
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Processing) {
-			cv::cvtColor(value, *matRender, cv::COLOR_GRAY2BGR);
+			renderLayer->setBase(value);
 		}
 
 		drawHistogram(value);
 
 		// combine rendering of processing with red channel for streets
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Processing) {
-			cv::Mat mask = cv::Mat::zeros(matTracking->size(), CV_8UC3);
-			cv::cvtColor(*matStreets, mask, cv::COLOR_GRAY2BGR);
-			cv::bitwise_and(*matTracking, mask, mask);
-			cv::bitwise_or(*matRender, mask, *matRender);
+			cv::Mat mask = cv::Mat::zeros(matCoarse->size(), CV_8UC3);
+			cv::cvtColor(*matStreetMask, mask, cv::COLOR_GRAY2BGR);
+			cv::bitwise_and(*matCoarse, mask, mask);
+			cv::bitwise_or(renderLayer->edit(), mask, renderLayer->edit());
 		}
 
 		*matProcessing = value.clone();
 	}
 
 
+	/**
+	 * Value channel with optimized contrast and red street mask of image. Kernel sizes grow with scale
+	 * to get the same result on the full resolution plane as on the coarse level.
+	 */
+
+	void PSDetect::processPixels(cv::Mat image, cv::Mat &value, cv::Mat &streets, float scale) {
+
+		// classify pixels with the colour table or in a single pass, the reference implementation is kept for validation
+		if(pixelKernel == "lut" && colorTable->classify(image, value, streets, thresholdDark, thresholdLight, thresholdRed)) {
+			PSProfiler::instance()->count("pixel lut");
+		}
+		else if(pixelKernel == "reference") {
+			pixelClassifier->classifyReference(image, value, streets);
+		}
+		else if(pixelKernel == "validate") {
+			cv::Mat fastValue, fastStreets;
+			pixelClassifier->classify(image, fastValue, fastStreets);
+			pixelClassifier->classifyReference(image, value, streets);
+			int mismatches = cv::countNonZero(fastValue != value) + cv::countNonZero(fastStreets != streets);
+			PSProfiler::instance()->count("pixel mismatches", mismatches);
+			if(mismatches > 0) { qDebug() << "detect: pixel kernel differs from reference in" << mismatches << "pixels"; }
+		}
+		else {
+			pixelClassifier->classify(image, value, streets);
+		}
+
+		// optimize streets channel and remove red pixels from value channel
+		int kernelSize = cvRound(5 * scale);
+		cv::Mat kernelDilate = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernelSize, kernelSize));
+		cv::medianBlur(streets, streets, 3);
+		cv::dilate(streets, streets, kernelDilate);
+		cv::subtract(value, streets, value);
+	}
+
+
 	void PSDetect::whiteBalance(cv::Mat &mat) {
 		
 		// get reference white
@@ -228,9 +318,9 @@
 		}
 
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Plane2D) {
-			*matRender = *matTracking;
+			renderLayer->setBase(*matTracking);
 			// draw white balance reference
-			cv::rectangle(*matRender, rect, cv::Scalar(0, 128, 255), 2);
+			renderLayer->drawRect(rect, cv::Scalar(0, 128, 255), 2);
 		}
 	}
 
@@ -251,7 +341,7 @@
 		for(int i = 0; i < 30; i++) { hist.at<float>(i) = 0; }
 		for(int i = 235; i < 255; i++) { hist.at<float>(i) = 0; }
 
-		// draw histogram to matRender
+		// draw histogram to render layer
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Processing) {
 
 			int hist_w = 200;
@@ -274,9 +364,369 @@
 			cv::line(histImage, cv::Point(thresholdLight, 0), cv::Point(thresholdLight, hist_h), cv::Scalar(180, 50, 180), 2, 8, 0);
 
 			// add histogram to render
-			cv::Rect roi = cv::Rect(0, 0, histImage.cols, histImage.rows);
-			histImage.copyTo((*matRender)(roi));
+			renderLayer->drawImage(histImage, cv::Point(0, 0));
+		}
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	COARSE TO FINE
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Downscale large planes to the detection width. Edges and streets are searched on this level,
+	 * thresholding and contours of the found regions run on the full resolution plane.
+	 */
+
+	void PSDetect::buildCoarseLevel() {
+
+		coarseScale = 1.0f;
+		if(detectWidth <= 0 || matTracking->cols <= detectWidth) {
+			*matCoarse = *matTracking;
+			return;
+		}
+
+		coarseScale = (float) matTracking->cols / detectWidth;
+		cv::Size size(detectWidth, cvRound(matTracking->rows / coarseScale));
+		cv::resize(*matTracking, *matCoarse, size, 0, 0, cv::INTER_AREA);
+	}
+
+
+	/**
+	 * Coarse rect on the full resolution plane, padded by one coarse pixel.
+	 */
+
+	cv::Rect PSDetect::toPlane(cv::Rect coarseRect) {
+
+		if(coarseScale == 1.0f) { return coarseRect; }
+
+		cv::Point tl(cvFloor((coarseRect.x - 1) * coarseScale), cvFloor((coarseRect.y - 1) * coarseScale));
+		cv::Point br(cvCeil((coarseRect.x + coarseRect.width + 1) * coarseScale), cvCeil((coarseRect.y + coarseRect.height + 1) * coarseScale));
+
+		return cv::Rect(tl, br) & cv::Rect(0, 0, matTracking->cols, matTracking->rows);
+	}
+
+
+	/**
+	 * Join overlapping regions, so every contour is found exactly once.
+	 */
+
+	std::vector<cv::Rect> PSDetect::mergeRegions(std::vector<cv::Rect> rects) {
+
+		std::vector<cv::Rect> merged;
+		for(cv::Rect rect : rects) {
+
+			// grow rect until no merged region overlaps anymore
+			bool overlaps = true;
+			while(overlaps) {
+				overlaps = false;
+				for(size_t i = 0; i < merged.size(); i++) {
+					if((merged[i] & rect).area() > 0) {
+						rect |= merged[i];
+						merged.erase(merged.begin() + i);
+						overlaps = true;
+						break;
+					}
+				}
+			}
+
+			merged.push_back(rect);
+		}
+
+		return merged;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CHANGES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Tiles can be processed on their own if the last frame has complete results of the same plane size,
+	 * the change detector compared against its reference and less than half of the plane changed. Debug views of the intermediate steps always process the whole plane.
+	 */
+
+	bool PSDetect::isIncremental(std::vector<cv::Rect> &tiles, bool isReset) {
+
+		// the last results must exist for the same plane size
+		if(!hasResults || isReset || matThreshold->size() != matTracking->size()) { return false; }
+		if(renderMode == RenderMode::PaperScope && (viewMode == PSViewMode::Processing || viewMode == PSViewMode::Streets || viewMode == PSViewMode::BoundingBoxes)) { return false; }
+
+		return (int) tiles.size() * 2 < changeDetector->getTileCount();
+	}
+
+
+	/**
+	 * Update processing, threshold and candidates inside the changed tiles (coarse level). Edge boxes touching
+	 * a changed tile are thresholded again, together with all boxes overlapping them, so pieces crossing
+	 * tile seams are traced as a whole. Candidates outside of this area are kept from the last frame.
+	 */
+
+	void PSDetect::updateTiles(std::vector<cv::Rect> &tiles) {
+
+		PSProfiler::instance()->count("detect tiles", tiles.size());
+
+		// reprocess pixels of changed tiles
+		bool streetsChanged = false;
+		for(cv::Rect &tile : tiles) {
+			if(cv::countNonZero((*matStreetMask)(tile)) > 0) { streetsChanged = true; }
+		}
+
+		processTiles(tiles, *matProcessing, *matStreetMask);
+
+		for(cv::Rect &tile : tiles) {
+			if(cv::countNonZero((*matStreetMask)(tile)) > 0) { streetsChanged = true; }
+		}
+
+		// edge boxes connected to the changed tiles
+		std::vector<cv::Rect> boxes = findEdgeBoxes();
+		std::vector<cv::Rect> refresh = tiles;
+		std::vector<bool> isRefreshed(boxes.size(), false);
+		bool grown = true;
+		while(grown) {
+			grown = false;
+			for(size_t i = 0; i < boxes.size(); i++) {
+				if(!isRefreshed[i] && intersects(boxes[i], refresh)) {
+					isRefreshed[i] = true;
+					refresh.push_back(boxes[i]);
+					grown = true;
+				}
+			}
+		}
+
+		// threshold refreshed area again
+		std::vector<cv::Rect> planeRefresh;
+		for(cv::Rect &rect : refresh) {
+			planeRefresh.push_back(toPlane(rect));
+			(*matThreshold)(planeRefresh.back()).setTo(cv::Scalar(0));
+		}
+
+		std::vector<cv::Rect> refreshedBoxes;
+		for(size_t i = 0; i < boxes.size(); i++) {
+			if(isRefreshed[i]) { refreshedBoxes.push_back(boxes[i]); }
+		}
+
+		regions.clear();
+		updateLocalThreshold(refreshedBoxes);
+		for(cv::Rect &box : refreshedBoxes) { thresholdBox(box); }
+
+		// keep shapes of unchanged tiles
+		std::vector<PSCandidate> kept;
+		for(PSCandidate &candidate : shapeCandidates) {
+			if(intersects(cv::boundingRect(candidate.contour), planeRefresh)) { continue; }
+			kept.push_back(candidate);
 		}
+		shapeCandidates = kept;
+
+		PSTaskGroup tasks;
+		if(streetsChanged) { tasks.run([this]() { findStreets(); }); }
+		traceContours(mergeRegions(planeRefresh), planeRefresh);
+		classifyShapes();
+		tasks.wait();
+
+		joinCandidates();
+	}
+
+
+	/**
+	 * True if rect is closer than 2px to one of rects. The margin covers the padding of toPlane(),
+	 * so boxes that are not refreshed never share pixels with refreshed ones.
+	 */
+
+	bool PSDetect::intersects(cv::Rect rect, std::vector<cv::Rect> &rects) {
+
+		cv::Rect grown(rect.x - 2, rect.y - 2, rect.width + 4, rect.height + 4);
+		for(cv::Rect &other : rects) {
+			if((grown & other).area() > 0) { return true; }
+		}
+
+		return false;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	TILES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Split an image into tiles of detectTile pixels. Tiles at the right and bottom border may be smaller.
+	 */
+
+	std::vector<cv::Rect> PSDetect::splitTiles(cv::Size size) {
+
+		int tileSize = std::max(detectTile, 32);
+
+		std::vector<cv::Rect> tiles;
+		for(int y = 0; y < size.height; y += tileSize) {
+			for(int x = 0; x < size.width; x += tileSize) {
+				tiles.push_back(cv::Rect(x, y, tileSize, tileSize) & cv::Rect(0, 0, size.width, size.height));
+			}
+		}
+
+		return tiles;
+	}
+
+
+	/**
+	 * Process pixels of coarse tiles in parallel. Tiles are padded for the filter kernels, every worker
+	 * only allocates scratch memory for its padded tile.
+	 */
+
+	void PSDetect::processTiles(std::vector<cv::Rect> tiles, cv::Mat &value, cv::Mat &streets) {
+
+		cv::Rect bounds(0, 0, matCoarse->cols, matCoarse->rows);
+
+		cv::parallel_for_(cv::Range(0, (int) tiles.size()), [&](const cv::Range &range) {
+			for(int i = range.start; i < range.end; i++) {
+
+				cv::Rect padded = cv::Rect(tiles[i].x - 8, tiles[i].y - 8, tiles[i].width + 16, tiles[i].height + 16) & bounds;
+				cv::Rect inner = tiles[i] - padded.tl();
+				cv::Mat tileValue, tileStreets;
+				processPixels((*matCoarse)(padded), tileValue, tileStreets, 1.0f);
+				tileValue(inner).copyTo(value(tiles[i]));
+				tileStreets(inner).copyTo(streets(tiles[i]));
+			}
+		});
+	}
+
+
+	/**
+	 * Threshold edge boxes in parallel. Results are copied in box order, overlapping boxes give the same
+	 * threshold as in sequential order.
+	 */
+
+	void PSDetect::thresholdBoxes(std::vector<cv::Rect> &boxes) {
+
+		std::vector<cv::Rect> rects;
+		for(cv::Rect &box : boxes) {
+			cv::Rect rect = toPlane(box);
+			if(rect.area() > 0) { rects.push_back(rect); }
+		}
+
+		std::vector<cv::Mat> rois(rects.size());
+		cv::parallel_for_(cv::Range(0, (int) rects.size()), [&](const cv::Range &range) {
+			for(int i = range.start; i < range.end; i++) { rois[i] = thresholdRect(rects[i]); }
+		});
+
+		for(size_t i = 0; i < rects.size(); i++) {
+			rois[i].copyTo((*matThreshold)(rects[i]));
+			regions.push_back(rects[i]);
+		}
+	}
+
+
+	/**
+	 * Trace contours of plane tiles in parallel. Every contour belongs to the tile containing its top left
+	 * corner. Contours cut by the padded tile border cross a seam: their parts are merged into stitch regions,
+	 * which are traced again as a whole. Shapes are classified afterwards in tile order.
+	 */
+
+	void PSDetect::traceTiles(std::vector<cv::Rect> searchRegions) {
+
+		cv::Rect bounds(0, 0, matThreshold->cols, matThreshold->rows);
+		int halo = std::max(detectTile, 32) / 4;
+
+		std::vector<cv::Rect> tiles;
+		for(cv::Rect &tile : splitTiles(bounds.size())) {
+			if(intersects(tile, searchRegions)) { tiles.push_back(tile); }
+		}
+
+		std::vector<std::vector<std::vector<cv::Point>>> tileContours(tiles.size());
+		std::vector<std::vector<cv::Rect>> tileCrossing(tiles.size());
+
+		cv::parallel_for_(cv::Range(0, (int) tiles.size()), [&](const cv::Range &range) {
+			for(int i = range.start; i < range.end; i++) {
+
+				cv::Rect padded = cv::Rect(tiles[i].x - halo, tiles[i].y - halo, tiles[i].width + 2 * halo, tiles[i].height + 2 * halo) & bounds;
+
+				std::vector<cv::Rect> cut;
+				for(std::vector<cv::Point> &contour : outerContours((*matThreshold)(padded), padded.tl(), coarseScale, &cut)) {
+
+					if(!tiles[i].contains(cv::boundingRect(contour).tl())) { continue; }
+
+					cv::approxPolyDP(contour, contour, 0.02 * cv::arcLength(contour, true), true);
+					tileContours[i].push_back(contour);
+				}
+
+				for(cv::Rect &rect : cut) {
+					tileCrossing[i].push_back(cv::Rect(rect.x - 2, rect.y - 2, rect.width + 4, rect.height + 4) & bounds);
+				}
+			}
+		});
+
+		// regions of contours crossing tile seams
+		std::vector<cv::Rect> crossing;
+		for(std::vector<cv::Rect> &rects : tileCrossing) { crossing.insert(crossing.end(), rects.begin(), rects.end()); }
+		std::vector<cv::Rect> stitch = mergeRegions(crossing);
+		PSProfiler::instance()->count("detect stitched", stitch.size());
+
+		// grow stitch regions until no contour is cut by their border
+		std::vector<std::vector<cv::Point>> stitched;
+		bool isComplete = stitch.empty();
+		while(!isComplete) {
+
+			isComplete = true;
+			stitched.clear();
+
+			for(cv::Rect &region : stitch) {
+
+				std::vector<cv::Rect> cut;
+				for(std::vector<cv::Point> &contour : outerContours((*matThreshold)(region), region.tl(), coarseScale, &cut)) {
+					cv::approxPolyDP(contour, contour, 0.02 * cv::arcLength(contour, true), true);
+					stitched.push_back(contour);
+				}
+
+				for(cv::Rect &rect : cut) {
+					region |= cv::Rect(rect.x - halo, rect.y - halo, rect.width + 2 * halo, rect.height + 2 * halo) & bounds;
+					isComplete = false;
+				}
+			}
+
+			if(!isComplete) { stitch = mergeRegions(stitch); }
+		}
+
+		// contours inside a stitch region are only taken from the stitch pass
+		for(std::vector<std::vector<cv::Point>> &contours : tileContours) {
+			for(std::vector<cv::Point> &contour : contours) {
+
+				cv::Rect rect = cv::boundingRect(contour);
+				bool isStitched = false;
+				for(cv::Rect &region : stitch) {
+					if(isInside(rect, region, bounds)) { isStitched = true; }
+				}
+
+				if(!isStitched) { createCandidate(contour); }
+			}
+		}
+
+		for(std::vector<cv::Point> &contour : stitched) { createCandidate(contour); }
+	}
+
+
+	/**
+	 * True if rect does not touch the border of region. Borders of the plane never cut a contour.
+	 */
+
+	bool PSDetect::isInside(cv::Rect rect, cv::Rect region, cv::Rect bounds) {
+
+		bool left = rect.x > region.x || region.x == bounds.x;
+		bool top = rect.y > region.y || region.y == bounds.y;
+		bool right = rect.br().x < region.br().x || region.br().x == bounds.br().x;
+		bool bottom = rect.br().y < region.br().y || region.br().y == bounds.br().y;
+
+		return left && top && right && bottom && (rect & region) == rect;
 	}
 
 
@@ -290,6 +740,32 @@
 
 	void PSDetect::applyThreshold() {
 
+		std::vector<cv::Rect> boxes = findEdgeBoxes();
+
+		PSProfiler::instance()->begin("detect threshold");
+		PSProfiler::instance()->count("detect boxes", boxes.size());
+
+		*matThreshold = cv::Mat::zeros(matTracking->size(), CV_8UC1);
+		regions.clear();
+		updateLocalThreshold(boxes);
+
+		if(detectTile > 0) { thresholdBoxes(boxes); }
+		else {
+			for(cv::Rect &box : boxes) { thresholdBox(box); }
+		}
+
+		PSProfiler::instance()->end("detect threshold");
+
+		drawThreshold();
+	}
+
+
+	/**
+	 * Bounding boxes of the outer edge contours on the coarse level.
+	 */
+
+	std::vector<cv::Rect> PSDetect::findEdgeBoxes() {
+
 		// edge detection to find regions of interests
 		cv::Mat edges;
 		cv::Canny(*matProcessing, edges, 100, 180);
@@ -300,67 +776,250 @@
 		cv::Rect roi = cv::Rect(0, 0, 240, 240);
 		edges(roi) = cv::Scalar(0);
 
-		// find contours of edges
-		std::vector<std::vector<cv::Point>> contours;
-		std::vector<cv::Vec4i> hierarchy;
-		cv::findContours(edges, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
+		// only outer contours of edges with a minimum area
+		std::vector<cv::Rect> boxes;
+		for(std::vector<cv::Point> &contour : outerContours(edges, cv::Point(0, 0), 1.0f)) {
+			boxes.push_back(cv::boundingRect(contour));
+		}
 
-		*matThreshold = cv::Mat::zeros(edges.size(), CV_8UC1);
+		return boxes;
+	}
 
-		// only outer contours of edges with a minimum area
-		for(int i = 0; i < (int) contours.size(); i++) {
-			
-			if(hierarchy[i][3] == -1 && isValidContour(contours[i])) {
 
-				// find bounding box of edge
-				cv::Rect rect = cv::boundingRect(contours[i]);
+	/**
+	 * Otsu thresholding on a coarse bounding box. Larger planes recompute the value channel of the box
+	 * on the full resolution plane. The processing mat is not changed, it is reused for unchanged tiles.
+	 */
 
-				// otsu thresholding on bounding box
-				cv::Mat roi = (*matProcessing)(rect);
-				cv::GaussianBlur(roi, roi, cv::Size(5, 5), 0);
-				cv::threshold(roi, roi, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-				roi.copyTo((*matThreshold)(rect));
-			}
+	void PSDetect::thresholdBox(cv::Rect box) {
+
+		cv::Rect rect = toPlane(box);
+		if(rect.area() == 0) { return; }
+
+		thresholdRect(rect).copyTo((*matThreshold)(rect));
+		regions.push_back(rect);
+	}
+
+
+	/**
+	 * Threshold of a plane rect. Local thresholds are cut from the mat computed in updateLocalThreshold(),
+	 * Otsu processes full resolution pixels again if detecting on a coarse level.
+	 */
+
+	cv::Mat PSDetect::thresholdRect(cv::Rect rect) {
+
+		if(thresholdMethod != "otsu") { return (*matLocal)(rect).clone(); }
+
+		cv::Mat value;
+		if(coarseScale > 1.0f) {
+			cv::Mat streets;
+			processPixels((*matTracking)(rect), value, streets, coarseScale);
+		}
+		else {
+			value = (*matProcessing)(rect);
+		}
+
+		cv::Mat roi;
+		cv::GaussianBlur(value, roi, cv::Size(5, 5), 0);
+		cv::threshold(roi, roi, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+		return roi;
+	}
+
+
+	/**
+	 * Local threshold of the whole processing mat in one pass. On a coarse level the boxes are merged and
+	 * every merged region is processed once at full resolution, padded by the window radius so windows at
+	 * its border see the same pixels as on the whole plane.
+	 */
+
+	void PSDetect::updateLocalThreshold(std::vector<cv::Rect> &boxes) {
+
+		if(thresholdMethod == "otsu") { return; }
+
+		if(coarseScale == 1.0f) {
+			localThreshold->apply(*matProcessing, *matLocal);
+			return;
 		}
 
+		if(matLocal->size() != matTracking->size()) { *matLocal = cv::Mat::zeros(matTracking->size(), CV_8UC1); }
+
+		std::vector<cv::Rect> rects;
+		for(cv::Rect &box : boxes) { rects.push_back(toPlane(box)); }
+
+		cv::Rect bounds(0, 0, matTracking->cols, matTracking->rows);
+		int radius = localThreshold->getRadius(coarseScale);
+
+		for(cv::Rect &region : mergeRegions(rects)) {
+
+			if(region.area() == 0) { continue; }
+			cv::Rect padded = cv::Rect(region.x - radius, region.y - radius, region.width + 2 * radius, region.height + 2 * radius) & bounds;
+
+			cv::Mat value, streets, roi;
+			processPixels((*matTracking)(padded), value, streets, coarseScale);
+			localThreshold->apply(value, roi, coarseScale);
+			roi(region - padded.tl()).copyTo((*matLocal)(region));
+		}
+	}
+
+
+	void PSDetect::drawThreshold() {
+
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Threshold) {
-			cv::cvtColor(*matThreshold, *matRender, cv::COLOR_GRAY2BGR);
+			renderLayer->setBase(*matThreshold);
 		}
 	}
 
 
 	void PSDetect::findContours() {
 
+		shapeCandidates.clear();
+
+		// whole plane on a single level, only the regions found on the coarse level otherwise
+		std::vector<cv::Rect> searchRegions = { cv::Rect(0, 0, matThreshold->cols, matThreshold->rows) };
+		if(coarseScale > 1.0f) { searchRegions = mergeRegions(regions); }
+
+		if(detectTile > 0) { traceTiles(searchRegions); }
+		else { traceContours(searchRegions, {}); }
+
+		classifyShapes();
+	}
+
+
+	/**
+	 * Create candidates from the outer contours in the search regions. If filter is not empty, only
+	 * contours overlapping one of its rects are used, e.g. the parts of the plane that changed.
+	 */
+
+	void PSDetect::traceContours(std::vector<cv::Rect> searchRegions, std::vector<cv::Rect> filter) {
+
+		for(cv::Rect &region : searchRegions) {
+
+			// only outer contours with a minimum area
+			for(std::vector<cv::Point> &contour : outerContours((*matThreshold)(region), region.tl(), coarseScale)) {
+
+				if(!filter.empty() && !intersects(cv::boundingRect(contour), filter)) { continue; }
+
+				// simplify contour
+				cv::approxPolyDP(contour, contour, 0.02 * cv::arcLength(contour, true), true);
+
+				createCandidate(contour);
+			}
+		}
+	}
+
+
+	/**
+	 * Valid outer contours of a binary image, offset moves them to plane coordinates. The components extractor
+	 * replaces the contour hierarchy by a single labeling pass. If cut is given, outer contours touching a
+	 * border of the image inside the plane are not returned, their bounding boxes are added to cut instead.
+	 */
+
+	std::vector<std::vector<cv::Point>> PSDetect::outerContours(cv::Mat binary, cv::Point offset, float scale, std::vector<cv::Rect> *cut) {
+
+		if(detectExtractor == "components") { return extractComponents(binary, offset, scale, cut); }
+
 		std::vector<std::vector<cv::Point>> contours;
 		std::vector<cv::Vec4i> hierarchy;
-		candidates.clear();
-		
-		// find contours
-		cv::findContours(*matThreshold, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
-		if(contours.size() == 0) { return; }
+		cv::findContours(binary, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, offset);
 
-		// only outer contours with a minimum area
+		cv::Rect region(offset, binary.size());
+		cv::Rect bounds(0, 0, matThreshold->cols, matThreshold->rows);
+
+		std::vector<std::vector<cv::Point>> outer;
 		for(int i = 0; i < (int) contours.size(); i++) {
-			
-			if(hierarchy[i][3] == -1 && isValidContour(contours[i])) {
 
-				// simplify contour
-				cv::approxPolyDP(contours[i], contours[i], 0.02 * cv::arcLength(contours[i], true), true);
-				
-				createCandidate(contours[i]);
+			if(hierarchy[i][3] != -1) { continue; }
+
+			cv::Rect rect = cv::boundingRect(contours[i]);
+			if(cut != nullptr && !isInside(rect, region, bounds)) {
+				cut->push_back(rect);
+				continue;
 			}
+
+			if(isValidContour(contours[i], scale)) { outer.push_back(contours[i]); }
 		}
+
+		return outer;
 	}
 
 
-	bool PSDetect::isValidContour(std::vector<cv::Point> contour) {
+	/**
+	 * Label blobs with their stats and only trace the contours of blobs that can pass isValidContour(). The area
+	 * of a contour through the pixel centres is at most (width - 1) * (height - 1) of the bounding box. Blobs
+	 * inside a hole of another blob are no outer contours, they are found by testing a pixel against the outer
+	 * contour of every blob whose box contains them.
+	 */
 
-		// minimum size of contour
-		if(contour.size() < 3) { return false; }
-		if(cv::contourArea(contour) < 150) { return false; }
+	std::vector<std::vector<cv::Point>> PSDetect::extractComponents(cv::Mat binary, cv::Point offset, float scale, std::vector<cv::Rect> *cut) {
+
+		cv::Mat labels, stats, centroids;
+		int count = cv::connectedComponentsWithStats(binary, labels, stats, centroids, 8, CV_32S);
+
+		std::vector<std::vector<cv::Point>> traced(count);
+		auto trace = [&](int label) -> std::vector<cv::Point>& {
+			if(traced[label].empty()) {
+				cv::Rect box(stats.at<int>(label, cv::CC_STAT_LEFT), stats.at<int>(label, cv::CC_STAT_TOP), stats.at<int>(label, cv::CC_STAT_WIDTH), stats.at<int>(label, cv::CC_STAT_HEIGHT));
+				std::vector<std::vector<cv::Point>> contours;
+				cv::findContours(labels(box) == label, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, box.tl());
+				if(!contours.empty()) { traced[label] = contours[0]; }
+			}
+			return traced[label];
+		};
+
+		std::vector<std::vector<cv::Point>> outer;
+		double minArea = 150 * scale * scale;
+		cv::Rect region(offset, binary.size());
+		cv::Rect bounds(0, 0, matThreshold->cols, matThreshold->rows);
 
-		// maximum size of contour
-		if(cv::contourArea(contour) > 300*300) { return false; }
+		for(int i = 1; i < count; i++) {
+
+			cv::Rect box(stats.at<int>(i, cv::CC_STAT_LEFT), stats.at<int>(i, cv::CC_STAT_TOP), stats.at<int>(i, cv::CC_STAT_WIDTH), stats.at<int>(i, cv::CC_STAT_HEIGHT));
+
+			// blobs cut by the image border are only reported, no tracing needed
+			if(cut != nullptr && !isInside(box + offset, region, bounds)) {
+				cut->push_back(box + offset);
+				continue;
+			}
+
+			if((double) (box.width - 1) * (box.height - 1) < minArea) { continue; }
+
+			// first pixel of the blob in its top row
+			const int *row = labels.ptr<int>(box.y);
+			int x = box.x;
+			while(row[x] != i) { x++; }
+
+			bool isNested = false;
+			for(int j = 1; j < count && !isNested; j++) {
+
+				cv::Rect other(stats.at<int>(j, cv::CC_STAT_LEFT), stats.at<int>(j, cv::CC_STAT_TOP), stats.at<int>(j, cv::CC_STAT_WIDTH), stats.at<int>(j, cv::CC_STAT_HEIGHT));
+				if(j == i || (other & box) != box || other == box) { continue; }
+
+				isNested = cv::pointPolygonTest(trace(j), cv::Point2f(x, box.y), false) > 0;
+			}
+			if(isNested) { continue; }
+
+			std::vector<cv::Point> contour = trace(i);
+			if(!isValidContour(contour, scale)) { continue; }
+
+			for(cv::Point &point : contour) { point += offset; }
+			outer.push_back(contour);
+		}
+
+		return outer;
+	}
+
+
+	/**
+	 * Size limits are given for the 960px detection level, scale converts them to the resolution of contour.
+	 */
+
+	bool PSDetect::isValidContour(const std::vector<cv::Point> &contour, float scale) {
+
+		// minimum and maximum size of contour
+		if(contour.size() < 3) { return false; }
+		double area = cv::contourArea(contour);
+		if(area < 150 * scale * scale || area > 300*300 * scale * scale) { return false; }
 
 		// no extreme aspect ratio
 		cv::RotatedRect rect = cv::minAreaRect(contour);
@@ -382,15 +1041,15 @@
 
 		// convert shapes to equal lines
 		cv::Mat matThinning;
-		cv::ximgproc::thinning(*matStreets, matThinning);
+		cv::ximgproc::thinning(*matStreetMask, matThinning);
 
 		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::Streets) {
 			cv::Mat channels[3];
-			cv::split(*matRender, channels);
+			cv::split(renderLayer->edit(), channels);
 			channels[0] *= 0.15;
 			channels[1] *= 0.15;
-			channels[2] = matThinning;
-			cv::merge(channels, 3, *matRender);
+			cv::resize(matThinning, channels[2], channels[0].size(), 0, 0, cv::INTER_NEAREST);
+			cv::merge(channels, 3, renderLayer->edit());
 		}
 
 		// equal width of streets
@@ -400,6 +1059,7 @@
 		std::vector<std::vector<cv::Point>> contours;
 		std::vector<cv::Vec4i> hierarchy;
 		cv::findContours(*matStreets, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
+		streetCandidates.clear();
 		if(contours.size() == 0) { return; }
 
 		// filter contours
@@ -407,17 +1067,14 @@
 			
             if(hierarchy[i][3] == -1 && cv::contourArea(contours[i]) > 300) {
 
-				// simplify contour
+				// simplify contour and scale from coarse level to plane
 				cv::approxPolyDP(contours[i], contours[i], 1, true);
+				for(cv::Point &point : contours[i]) { point = cv::Point(point.x * coarseScale, point.y * coarseScale); }
 
 				PSCandidate candidate(contours[i], PSShapeType::Street);
-				candidates.push_back(candidate);
+				streetCandidates.push_back(candidate);
 			}
 		}
-		
-		if(renderMode == RenderMode::PaperScope && viewMode == PSViewMode::BoundingBoxes) {
-			cv::add(*matThreshold, *matStreets, *matThreshold);
-		}
 	}
 
 
@@ -434,13 +1091,31 @@
 		cv::Rect rect = cv::boundingRect(contour);
 		if(rect.width < 1|| rect.height < 1) { return; }
 
-		// classify shape
-		cv::Mat roi = (*matThreshold)(rect);
-		PSShapeType shapeType = classifyShape(roi);
+		// unchanged shapes keep their label, all others are classified with the candidates of the frame
+		PSCandidate candidate(contour, PSShapeType::Rectangle);
+		bool isClassified = false;
+		int entry = isCacheEnabled ? shapeCache->lookup(rect, *matThreshold, isClassified) : -1;
+		if(isClassified) {
+			candidate.shapeType = shapeCache->getLabel(entry);
+			PSProfiler::instance()->count("detect cache hits");
+		}
+		else {
+			candidate.isProvisional = true;
+			pendingShapes.push_back(shapeCandidates.size());
+			pendingEntries.push_back(entry);
+		}
+		shapeCandidates.push_back(candidate);
+	}
+
+
+	/**
+	 * Shapes first, then streets. The order does not depend on which branch finished first.
+	 */
+
+	void PSDetect::joinCandidates() {
 
-		// create candidate
-		PSCandidate candidate(contour, shapeType);
-		candidates.push_back(candidate);
+		candidates = shapeCandidates;
+		candidates.insert(candidates.end(), streetCandidates.begin(), streetCandidates.end());
 	}
 
 
@@ -448,16 +1123,23 @@
 
 		if(renderMode != RenderMode::PaperScope) { return; }
 
-		// render threshold mat
-		if(viewMode > PSViewMode::Streets) {
-			cv::cvtColor(*matThreshold, *matRender, cv::COLOR_GRAY2BGR);
-			cv::multiply(*matRender, 0.25, *matRender);
+		// render threshold mat, with streets for bounding boxes
+		if(viewMode == PSViewMode::BoundingBoxes) {
+			cv::Mat streets;
+			cv::resize(*matStreets, streets, matThreshold->size(), 0, 0, cv::INTER_NEAREST);
+			cv::add(*matThreshold, streets, streets);
+			renderLayer->setBase(streets);
+			renderLayer->fade(0.25);
+		}
+		else if(viewMode > PSViewMode::Streets) {
+			renderLayer->setBase(*matThreshold);
+			renderLayer->fade(0.25);
 		}
 
 		// render candidates bounding boxes
 		if(viewMode == PSViewMode::BoundingBoxes) {
 			for(int i = 0; i < (int) candidates.size(); i++) {
-				candidates[i].drawBoundingBox(matRender);
+				candidates[i].drawBoundingBox(renderLayer);
 			}
 		}
 	}
@@ -471,59 +1153,131 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
+	/**
+	 * Collect the classifier variants allowed by the settings and keep the fastest on this CPU. Model, delegate
+	 * and thread count can each be fixed, "auto" and a thread count of 0 include all options in the benchmark.
+	 */
+
 	void PSDetect::initAI() {
 
-		// load model
-		QString filePath = QCoreApplication::applicationDirPath() + "/shape-classifier_v4.tflite";
-		model = tflite::FlatBufferModel::BuildFromFile(filePath.toStdString().c_str()); 
+		QString directory = QCoreApplication::applicationDirPath();
+		QString modelSetting = Settings::instance()->getString("classifier_model", "auto");
+		QString delegateSetting = Settings::instance()->getString("classifier_delegate", "auto");
+		int threadSetting = Settings::instance()->getInt("classifier_threads", 0);
+
+		// models
+		std::vector<std::string> paths;
+		if(modelSetting != "int8") { paths.push_back((directory + "/shape-classifier_v4.tflite").toStdString()); }
+		if(modelSetting != "float") { paths.push_back((directory + "/shape-classifier_v4_int8.tflite").toStdString()); }
+
+		// delegates
+		std::vector<bool> delegates;
+		if(delegateSetting != "none") { delegates.push_back(true); }
+		if(delegateSetting != "xnnpack") { delegates.push_back(false); }
+
+		// threads
+		std::vector<int> threads = {std::max(threadSetting, 1)};
+		int idealThreads = std::min(QThread::idealThreadCount(), 4);
+		if(threadSetting <= 0 && idealThreads > 1) { threads.push_back(idealThreads); }
+
+		std::vector<PSShapeClassifier::Variant> variants;
+		for(std::string &path : paths) {
+			for(bool xnnpack : delegates) {
+				for(int count : threads) { variants.push_back({path, xnnpack, count}); }
+			}
+		}
 
-		// create interpreter
-		resolver = new tflite::ops::builtin::BuiltinOpResolver();
-		tflite::InterpreterBuilder(*model, *resolver)(&interpreter);
-		interpreter->AllocateTensors();
+		if(!shapeClassifier->select(variants)) {
+			qDebug() << "detect: no shape classifier could be loaded";
+		}
 	}
 
 
-	PSShapeType PSDetect::classifyShape(cv::Mat roi) {
-
-		// skip on empty roi
-		if(roi.empty() || roi.cols==0 || roi.rows == 0) { return PSShapeType::Rectangle; }
-
-		// resize image
-		cv::resize(roi, roi, cv::Size(54, 54));
-
-		// add padding of 3 pixels
-		cv::Mat padded = cv::Mat(64, 64, CV_8UC1, cv::Scalar(0));
-		roi.copyTo(padded(cv::Rect(5, 5, roi.cols, roi.rows)));
+	/**
+	 * Classify the candidates created since the last call and the ones deferred on earlier frames in a single
+	 * batch. At most classifierBudget shapes are classified per frame, more only if the queue grows beyond
+	 * classifierQueue. Shapes without any result come first, larger ones before smaller ones. The others keep
+	 * a provisional shape and stay in the queue. Results of cached shapes are votes, the candidate takes the
+	 * majority of its entry.
+	 */
 
-		// convert to float
-		cv::Mat floatImg;
-		padded.convertTo(floatImg, CV_32FC1, 1.0 / 255.0);
+	void PSDetect::classifyShapes() {
 
-		// set input tensor
-		float *input = interpreter->typed_input_tensor<float>(0);
-		for(int i = 0; i < 64; i++) {
-			for(int j = 0; j < 64; j++) {
-				input[i * 64 + j] = floatImg.at<float>(i, j);
+		// provisional shapes kept from the last frames, their cache entries are gone
+		std::vector<bool> isPending(shapeCandidates.size(), false);
+		for(size_t index : pendingShapes) { isPending[index] = true; }
+		for(size_t i = 0; i < shapeCandidates.size(); i++) {
+			if(shapeCandidates[i].isProvisional && !isPending[i]) {
+				pendingShapes.push_back(i);
+				pendingEntries.push_back(-1);
 			}
 		}
 
-		// run inference
-		interpreter->Invoke();
-
-		// get output tensor
-		float *output = interpreter->typed_output_tensor<float>(0);
-		
-		int maxIndex = 0;
-		float maxValue = output[0];
-		for(int i = 1; i < 5; i++) {
-			if(output[i] > maxValue) {
-				maxIndex = i;
-				maxValue = output[i];
+		// priority
+		std::vector<int> votes(pendingShapes.size(), 0);
+		std::vector<int> areas(pendingShapes.size(), 0);
+		std::vector<size_t> order(pendingShapes.size());
+		for(size_t i = 0; i < pendingShapes.size(); i++) {
+			if(pendingEntries[i] >= 0) { votes[i] = shapeCache->getVotes(pendingEntries[i]); }
+			areas[i] = cv::boundingRect(shapeCandidates[pendingShapes[i]].contour).area();
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return votes[a] != votes[b] ? votes[a] < votes[b] : areas[a] > areas[b];
+		});
+
+		int count = (int) order.size();
+		int classified = count;
+		if(classifierBudget > 0) { classified = std::min(count, std::max(classifierBudget, count - std::max(classifierQueue, 0))); }
+
+		std::vector<cv::Rect> rects;
+		for(int k = 0; k < classified; k++) { rects.push_back(cv::boundingRect(shapeCandidates[pendingShapes[order[k]]].contour)); }
+
+		std::vector<PSShapeType> types;
+		int calls = shapeClassifier->classify(*matThreshold, rects, types);
+		for(int k = 0; k < classified; k++) {
+			size_t i = order[k];
+			if(pendingEntries[i] >= 0) {
+				shapeCache->vote(pendingEntries[i], types[k]);
+				types[k] = shapeCache->getLabel(pendingEntries[i]);
 			}
+			shapeCandidates[pendingShapes[i]].shapeType = types[k];
+			shapeCandidates[pendingShapes[i]].isProvisional = false;
 		}
 
-		return (PSShapeType) maxIndex;
+		// over budget, label of the cache or a guess from the contour until classified
+		for(int k = classified; k < count; k++) {
+			size_t i = order[k];
+			PSCandidate &candidate = shapeCandidates[pendingShapes[i]];
+			candidate.shapeType = votes[i] > 0 ? shapeCache->getLabel(pendingEntries[i]) : guessShape(candidate.contour);
+			candidate.isProvisional = true;
+		}
+		deferredShapes = count - classified;
+
+		PSProfiler::instance()->count("detect inferences", calls);
+		PSProfiler::instance()->count("detect queue", count);
+		PSProfiler::instance()->count("detect deferred", deferredShapes);
+		pendingShapes.clear();
+		pendingEntries.clear();
+		shapeCache->nextFrame();
+	}
+
+
+	/**
+	 * Provisional shape of a candidate waiting for classification, from the corners of the simplified contour.
+	 */
+
+	PSShapeType PSDetect::guessShape(std::vector<cv::Point> &contour) {
+
+		size_t corners = contour.size();
+		bool isConvex = cv::isContourConvex(contour);
+
+		if(corners == 3) { return PSShapeType::Triangle; }
+		if(corners == 4) { return PSShapeType::Rectangle; }
+		if(corners > 6 && isConvex) { return PSShapeType::Circle; }
+		if(corners == 12 && !isConvex) { return PSShapeType::Cross; }
+
+		return PSShapeType::Organic;
 	}
 
 
@@ -562,8 +1316,54 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
 
 
+	/**
+	 * Called on the main thread, settings are queued and applied before the next frame. A newer value
+	 * replaces a queued one of the same key.
+	 */
+
 	void PSDetect::onSettingsUpdated(QString key, QVariant value) {
 
+		std::lock_guard<std::mutex> lock(settingsMutex);
+		for(auto it = pendingSettings.begin(); it != pendingSettings.end(); it++) {
+			if(it->first == key) {
+				pendingSettings.erase(it);
+				break;
+			}
+		}
+		pendingSettings.push_back({key, value});
+	}
+
+
+	/**
+	 * Apply the queued settings on the processing thread, the classifier is loaded once for all its keys.
+	 */
+
+	void PSDetect::applySettings() {
+
+		std::vector<std::pair<QString, QVariant>> settings;
+		{
+			std::lock_guard<std::mutex> lock(settingsMutex);
+			if(pendingSettings.empty()) { return; }
+			settings.swap(pendingSettings);
+		}
+
+		bool needsInit = false;
+		for(std::pair<QString, QVariant> &setting : settings) {
+			needsInit = applySetting(setting.first, setting.second) || needsInit;
+		}
+		if(needsInit) { initAI(); }
+	}
+
+
+	/**
+	 * Returns true if the shape classifier has to be loaded again.
+	 */
+
+	bool PSDetect::applySetting(QString key, QVariant value) {
+
+		// next frame is processed completely
+		hasResults = false;
+
 		if(key == "renderMode") {
 			renderMode = (RenderMode) value.toInt();
 		}
@@ -579,8 +1379,59 @@
 		else if(key == "threshold_red") {
 			thresholdRed = value.toInt();
 		}
+		else if(key == "threshold_method") {
+			thresholdMethod = value.toString();
+			localThreshold->method = thresholdMethod == "bradley" ? PSLocalThreshold::Method::Bradley : PSLocalThreshold::Method::Sauvola;
+		}
+		else if(key == "threshold_window") {
+			localThreshold->windowSize = value.toInt();
+		}
+
+		else if(key == "detect_width") {
+			detectWidth = value.toInt();
+		}
+		else if(key == "detect_tile") {
+			detectTile = value.toInt();
+		}
+		else if(key == "detect_extractor") {
+			detectExtractor = value.toString();
+		}
+		else if(key == "pixel_kernel") {
+			pixelKernel = value.toString();
+		}
+		else if(key == "classifier_model" || key == "classifier_delegate" || key == "classifier_threads") {
+			return true;
+		}
+		else if(key == "classifier_cache") {
+
+			// applied between frames, pending shapes keep no index into the cleared cache
+			isCacheEnabled = value.toBool();
+			shapeCache->clear();
+			std::fill(pendingEntries.begin(), pendingEntries.end(), -1);
+		}
+		else if(key == "classifier_budget") {
+			classifierBudget = value.toInt();
+		}
+		else if(key == "classifier_queue") {
+			classifierQueue = value.toInt();
+		}
+		else if(key == "change_threshold") {
+			changeDetector->threshold = value.toInt();
+		}
+		else if(key == "change_tile") {
+			changeDetector->tileSize = value.toInt();
+			changeDetector->reset();
+		}
 		else if(key == "capture_dataset") {
 			captureDataset = true;
 		}
+
+		// rebuild colour table in the background, frames are classified without it until it is ready
+		bool isThreshold = key == "threshold_dark" || key == "threshold_light" || key == "threshold_red";
+		if(pixelKernel == "lut" && (isThreshold || key == "pixel_kernel")) {
+			colorTable->request(thresholdDark, thresholdLight, thresholdRed);
+		}
+
+		return false;
 	}
 
@@ -7,21 +7,28 @@
 
 	#pragma once
 
+	// C++
+	#include <mutex>
+	#include <utility>
+	#include <vector>
+
 	// Qt
 	#include <QObject>
 
 	// OpenCV
 	#include <opencv2/opencv.hpp>
 
-	// Tensorflow
-	#include "tensorflow/lite/kernels/register.h"
-	#include "tensorflow/lite/model.h"
-	#include "tensorflow/lite/interpreter.h"
-
 	// App
 	#include "../PSTrackingMode.h"
 	#include "../PSViewMode.h"
 	#include "PSCandidate.h"
+	#include "PSChangeDetector.h"
+	#include "PSPixelClassifier.h"
+	#include "PSColorTable.h"
+	#include "PSLocalThreshold.h"
+	#include "PSShapeClassifier.h"
+	#include "PSShapeCache.h"
+	#include "../PSRenderLayer.h"
 	#include "PSShapeType.h"
 	#include "PSShapeType.h"
 	#include "../../global/Settings.h"
@@ -47,36 +54,81 @@ class PSDetect : public QObject {
 
 		// processing
 		void init();
-		void update(cv::Mat *mTracking, cv::Mat *mRender, PSTrackingMode trackingMode);
+		void update(cv::Mat *mTracking, PSRenderLayer *layer, PSTrackingMode trackingMode);
+		void maskTracking();
 		void close();
 
 		// opencv
 		cv::Mat *matTracking;
 		cv::Mat *matProcessing;
 		cv::Mat *matThreshold;
-		cv::Mat *matRender;
+		cv::Mat *matCoarse;
+		cv::Mat *matLocal;
+		PSRenderLayer *renderLayer;
 
 		// image processing
 		void imageProcessing();
+		void processPixels(cv::Mat image, cv::Mat &value, cv::Mat &streets, float scale);
 		void whiteBalance(cv::Mat &mat);
 		void drawHistogram(cv::Mat &value);
+		PSPixelClassifier *pixelClassifier;
+		PSColorTable *colorTable;
+		QString pixelKernel;
 
 		// detection
 		void applyThreshold();
+		std::vector<cv::Rect> findEdgeBoxes();
+		void thresholdBox(cv::Rect box);
+		cv::Mat thresholdRect(cv::Rect rect);
+		void updateLocalThreshold(std::vector<cv::Rect> &boxes);
+		void drawThreshold();
 		void findContours();
-		bool isValidContour(std::vector<cv::Point> contour);
+		void traceContours(std::vector<cv::Rect> searchRegions, std::vector<cv::Rect> filter);
+		std::vector<std::vector<cv::Point>> outerContours(cv::Mat binary, cv::Point offset, float scale, std::vector<cv::Rect> *cut = nullptr);
+		std::vector<std::vector<cv::Point>> extractComponents(cv::Mat binary, cv::Point offset, float scale, std::vector<cv::Rect> *cut = nullptr);
+		bool isValidContour(const std::vector<cv::Point> &contour, float scale = 1.0f);
 		int thresholdDark;
 		int thresholdLight;
 		int thresholdRed;
+		QString detectExtractor;
+		PSLocalThreshold *localThreshold;
+		QString thresholdMethod;
+
+		// coarse to fine
+		void buildCoarseLevel();
+		cv::Rect toPlane(cv::Rect coarseRect);
+		std::vector<cv::Rect> mergeRegions(std::vector<cv::Rect> rects);
+		std::vector<cv::Rect> regions;
+		int detectWidth;
+		float coarseScale;
+
+		// changes
+		bool isIncremental(std::vector<cv::Rect> &tiles, bool isReset);
+		void updateTiles(std::vector<cv::Rect> &tiles);
+		bool intersects(cv::Rect rect, std::vector<cv::Rect> &rects);
+		PSChangeDetector *changeDetector;
+		bool hasResults;
+
+		// tiles
+		std::vector<cv::Rect> splitTiles(cv::Size size);
+		void processTiles(std::vector<cv::Rect> tiles, cv::Mat &value, cv::Mat &streets);
+		void thresholdBoxes(std::vector<cv::Rect> &boxes);
+		void traceTiles(std::vector<cv::Rect> searchRegions);
+		bool isInside(cv::Rect rect, cv::Rect region, cv::Rect bounds);
+		int detectTile;
 
 		// streets
 		void findStreets();
 		cv::Mat *matStreets;
+		cv::Mat *matStreetMask;
 
 		// candidates
 		void createCandidate(std::vector<cv::Point> contour);
+		void joinCandidates();
 		void drawCandidates();
 		std::vector<PSCandidate> candidates;
+		std::vector<PSCandidate> shapeCandidates;
+		std::vector<PSCandidate> streetCandidates;
 
 
 	private:
@@ -87,15 +139,27 @@ class PSDetect : public QObject {
 
 		// ai
 		void initAI();
-        PSShapeType classifyShape(cv::Mat roi);
-		tflite::impl::FlatBufferModel::Ptr model;
-		tflite::ops::builtin::BuiltinOpResolver *resolver;
-		std::unique_ptr<tflite::Interpreter> interpreter;
+		void classifyShapes();
+		PSShapeType guessShape(std::vector<cv::Point> &contour);
+		PSShapeClassifier *shapeClassifier;
+		PSShapeCache *shapeCache;
+		std::vector<size_t> pendingShapes;
+		std::vector<int> pendingEntries;
+		bool isCacheEnabled;
+		int classifierBudget;
+		int classifierQueue;
+		int deferredShapes;
 
 		// dataset capture
 		void saveDataset(cv::Rect rect);
 		bool captureDataset;
 
+		// settings arrive on the main thread
+		void applySettings();
+		bool applySetting(QString key, QVariant value);
+		std::mutex settingsMutex;
+		std::vector<std::pair<QString, QVariant>> pendingSettings;
+
 	
 	public slots:
 
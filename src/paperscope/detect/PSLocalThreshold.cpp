@@ -0,0 +1,154 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSLocalThreshold.h"
+
+	// C++
+	#include <algorithm>
+	#include <cmath>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/core/hal/intrin.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSLocalThreshold::PSLocalThreshold()
+		: method(Method::Sauvola),
+		  windowSize(41),
+		  sauvolaK(0.2f),
+		  bradleyT(0.15f),
+		  minContrast(16)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	THRESHOLD
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Pieces are dark on a bright table in the camera image, the value channel is inverted. Both methods
+	 * are applied to the original polarity. The window grows with scale to match the coarse level.
+	 */
+
+	void PSLocalThreshold::apply(cv::Mat value, cv::Mat &threshold, float scale) {
+
+		CV_Assert(value.type() == CV_8UC1);
+
+		int rows = value.rows;
+		int cols = value.cols;
+		int radius = getRadius(scale);
+		cv::Size window(2 * radius + 1, 2 * radius + 1);
+
+		// window sums, the zero border clips windows to the image
+		cv::Mat sum, sqsum;
+		cv::boxFilter(value, sum, CV_32F, window, cv::Point(-1, -1), false, cv::BORDER_CONSTANT);
+		cv::sqrBoxFilter(value, sqsum, CV_32F, window, cv::Point(-1, -1), false, cv::BORDER_CONSTANT);
+		threshold.create(value.size(), CV_8UC1);
+
+		// pixel count of a clipped window is the product of its clipped width and height
+		std::vector<float> invWidth(cols);
+		for(int x = 0; x < cols; x++) { invWidth[x] = 1.0f / (std::min(x + radius + 1, cols) - std::max(x - radius, 0)); }
+
+		for(int y = 0; y < rows; y++) {
+			float invHeight = 1.0f / (std::min(y + radius + 1, rows) - std::max(y - radius, 0));
+			thresholdRow(value.ptr<uchar>(y), sum.ptr<float>(y), sqsum.ptr<float>(y), invWidth.data(), invHeight, threshold.ptr<uchar>(y), cols);
+		}
+	}
+
+
+	/**
+	 * Half window size in pixels of a level with the given scale.
+	 */
+
+	int PSLocalThreshold::getRadius(float scale) {
+
+		return std::max(1, cvRound(windowSize * scale) / 2);
+	}
+
+
+	/**
+	 * Both methods compare the inverted pixel to background * (factor + slope * deviation), the inverted
+	 * window mean being the background. Low contrast is tested on the variance.
+	 */
+
+	void PSLocalThreshold::thresholdRow(const uchar *value, const float *sum, const float *sqsum, const float *invWidth, float invHeight, uchar *threshold, int width) {
+
+		float factor = method == Method::Sauvola ? 1.0f - sauvolaK : 1.0f - bradleyT;
+		float slope = method == Method::Sauvola ? sauvolaK / 128.0f : 0.0f;
+		float minVariance = (float) minContrast * minContrast;
+
+		int j = 0;
+
+	#if CV_SIMD
+		const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+		const int floatLanes = cv::VTraits<cv::v_float32>::vlanes();
+
+		cv::v_float32 v255 = cv::vx_setall_f32(255.0f), vZero = cv::vx_setzero_f32();
+		cv::v_float32 vFactor = cv::vx_setall_f32(factor), vSlope = cv::vx_setall_f32(slope);
+		cv::v_float32 vMinVariance = cv::vx_setall_f32(minVariance), vInvHeight = cv::vx_setall_f32(invHeight);
+		cv::v_uint8 vMid = cv::vx_setall_u8(128);
+
+		for(; j <= width - lanes; j += lanes) {
+
+			cv::v_uint8 pixels = cv::vx_load(value + j);
+			cv::v_uint16 p16[2];
+			cv::v_uint32 p32[4];
+			cv::v_expand(pixels, p16[0], p16[1]);
+			cv::v_expand(p16[0], p32[0], p32[1]);
+			cv::v_expand(p16[1], p32[2], p32[3]);
+
+			// window statistics in four float vectors
+			cv::v_int32 isPiece[4], isFlat[4];
+			for(int k = 0; k < 4; k++) {
+
+				int x = j + k * floatLanes;
+				cv::v_float32 invArea = cv::v_mul(vInvHeight, cv::vx_load(invWidth + x));
+				cv::v_float32 mean = cv::v_mul(cv::vx_load(sum + x), invArea);
+				cv::v_float32 variance = cv::v_max(cv::v_sub(cv::v_mul(cv::vx_load(sqsum + x), invArea), cv::v_mul(mean, mean)), vZero);
+				cv::v_float32 limit = cv::v_mul(cv::v_sub(v255, mean), cv::v_fma(vSlope, cv::v_sqrt(variance), vFactor));
+				cv::v_float32 pixel = cv::v_sub(v255, cv::v_cvt_f32(cv::v_reinterpret_as_s32(p32[k])));
+
+				isPiece[k] = cv::v_reinterpret_as_s32(cv::v_le(pixel, limit));
+				isFlat[k] = cv::v_reinterpret_as_s32(cv::v_lt(variance, vMinVariance));
+			}
+
+			// masks are 0 or -1 and survive the saturating packs
+			cv::v_uint8 piece = cv::v_reinterpret_as_u8(cv::v_pack(cv::v_pack(isPiece[0], isPiece[1]), cv::v_pack(isPiece[2], isPiece[3])));
+			cv::v_uint8 flat = cv::v_reinterpret_as_u8(cv::v_pack(cv::v_pack(isFlat[0], isFlat[1]), cv::v_pack(isFlat[2], isFlat[3])));
+
+			cv::v_store(threshold + j, cv::v_select(flat, cv::v_ge(pixels, vMid), piece));
+		}
+	#endif
+
+		// remaining pixels
+		for(; j < width; j++) {
+
+			float invArea = invHeight * invWidth[j];
+			float mean = sum[j] * invArea;
+			float variance = std::max(sqsum[j] * invArea - mean * mean, 0.0f);
+
+			bool isPiece;
+			if(variance < minVariance) { isPiece = value[j] >= 128; }
+			else { isPiece = 255.0f - value[j] <= (255.0f - mean) * (factor + slope * std::sqrt(variance)); }
+
+			threshold[j] = isPiece ? 255 : 0;
+		}
+	}
@@ -0,0 +1,56 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Local threshold of the inverted value channel. Window sums of the pixels and their squares come from
+ * two box filters, mean, deviation and threshold of every pixel from a single SIMD pass over the rows. The
+ * cost does not depend on the window size. Windows without contrast fall back to the mid level, large
+ * pieces are not hollowed out.
+ */
+
+class PSLocalThreshold {
+
+	public:
+
+		enum class Method {
+			Sauvola,
+			Bradley
+		};
+
+		PSLocalThreshold();
+
+		// threshold
+		void apply(cv::Mat value, cv::Mat &threshold, float scale = 1.0f);
+		int getRadius(float scale = 1.0f);
+
+		// settings
+		Method method;
+		int windowSize;
+		float sauvolaK;
+		float bradleyT;
+		int minContrast;
+
+
+	private:
+
+		// rows
+		void thresholdRow(const uchar *value, const float *sum, const float *sqsum, const float *invWidth, float invHeight, uchar *threshold, int width);
+};
@@ -0,0 +1,305 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSPixelClassifier.h"
+
+	// OpenCV
+	#include <opencv2/core/hal/intrin.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	int PSPixelClassifier::sdivTable[256];
+	int PSPixelClassifier::hdivTable[256];
+
+
+	PSPixelClassifier::PSPixelClassifier()
+		: thresholdDark(50),
+		  thresholdLight(180),
+		  thresholdRed(150),
+		  hueLow(0),
+		  hueHigh(180)
+	{
+
+		initTables();
+		setThresholds(thresholdDark, thresholdLight, thresholdRed);
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	THRESHOLDS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * The red hue range is a float in the reference, it is converted to the integer limits hue < hueLow
+	 * and hue > hueHigh by testing every possible hue with the same expression.
+	 */
+
+	void PSPixelClassifier::setThresholds(int dark, int light, int red) {
+
+		thresholdDark = std::min(std::max(dark, 0), 256);
+		thresholdLight = std::min(std::max(light, -1), 255);
+		thresholdRed = red;
+
+		float range = thresholdRed/255.0 * 50;
+
+		hueLow = 0;
+		while(hueLow < 256 && hueLow < range) { hueLow++; }
+
+		hueHigh = 255;
+		for(int hue = 0; hue < 256; hue++) {
+			if(hue > 180 - range) {
+				hueHigh = hue - 1;
+				break;
+			}
+		}
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	HSV
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Same fixed point tables as cv::cvtColor(COLOR_BGR2HSV) for 8-bit images.
+	 */
+
+	void PSPixelClassifier::initTables() {
+
+		// classifiers may be created on different threads
+		static bool initialized = []() {
+			sdivTable[0] = hdivTable[0] = 0;
+			for(int i = 1; i < 256; i++) {
+				sdivTable[i] = cv::saturate_cast<int>((255 << 12) / (1. * i));
+				hdivTable[i] = cv::saturate_cast<int>((180 << 12) / (6. * i));
+			}
+			return true;
+		}();
+		(void) initialized;
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASSIFICATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	void PSPixelClassifier::classify(cv::Mat image, cv::Mat &value, cv::Mat &streets) {
+
+		CV_Assert(image.type() == CV_8UC3);
+
+		value.create(image.size(), CV_8UC1);
+		streets.create(image.size(), CV_8UC1);
+
+		for(int i = 0; i < image.rows; i++) {
+			classifyRow(image.ptr<uchar>(i), value.ptr<uchar>(i), streets.ptr<uchar>(i), image.cols);
+		}
+	}
+
+
+	void PSPixelClassifier::classifyRow(const uchar *bgr, uchar *value, uchar *streets, int width) {
+
+		int j = 0;
+
+	#if CV_SIMD
+		const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+		int CV_DECL_ALIGNED(CV_SIMD_WIDTH) indices[cv::VTraits<cv::v_uint8>::max_nlanes];
+
+		// x < limit is tested as x <= limit - 1 and x > limit as x >= limit + 1 to stay in 8 bit
+		cv::v_uint8 vDark = cv::vx_setall_u8((uchar) std::max(thresholdDark - 1, 0));
+		cv::v_uint8 vLight = cv::vx_setall_u8((uchar) std::min(thresholdLight + 1, 255));
+		cv::v_uint8 vHueLow = cv::vx_setall_u8((uchar) std::max(hueLow - 1, 0));
+		cv::v_uint8 vHueHigh = cv::vx_setall_u8((uchar) std::min(hueHigh + 1, 255));
+		cv::v_uint8 v50 = cv::vx_setall_u8(50), v60 = cv::vx_setall_u8(60), v70 = cv::vx_setall_u8(70);
+		cv::v_uint8 v10 = cv::vx_setall_u8(10), v20 = cv::vx_setall_u8(20), v150 = cv::vx_setall_u8(150);
+		cv::v_uint8 v255 = cv::vx_setall_u8(255), vZero = cv::vx_setzero_u8();
+		cv::v_int32 vRound = cv::vx_setall_s32(1 << 11), vHueRange = cv::vx_setall_s32(180), vZero32 = cv::vx_setzero_s32();
+
+		// comparisons outside of 0..255 are always false
+		cv::v_uint8 vDarkOn = thresholdDark > 0 ? v255 : vZero;
+		cv::v_uint8 vLightOn = thresholdLight < 255 ? v255 : vZero;
+		cv::v_uint8 vHueLowOn = hueLow > 0 ? v255 : vZero;
+		cv::v_uint8 vHueHighOn = hueHigh < 255 ? v255 : vZero;
+
+		for(; j <= width - lanes; j += lanes) {
+
+			cv::v_uint8 b, g, r;
+			cv::v_load_deinterleave(bgr + j * 3, b, g, r);
+
+			// hsv value and saturation
+			cv::v_uint8 v = cv::v_max(b, cv::v_max(g, r));
+			cv::v_uint8 diff = cv::v_sub(v, cv::v_min(b, cv::v_min(g, r)));
+
+			// widen to 32 bit for the fixed point divisions
+			cv::v_uint16 v16[2], diff16[2], b16[2], g16[2], r16[2];
+			cv::v_expand(v, v16[0], v16[1]);
+			cv::v_expand(diff, diff16[0], diff16[1]);
+			cv::v_expand(b, b16[0], b16[1]);
+			cv::v_expand(g, g16[0], g16[1]);
+			cv::v_expand(r, r16[0], r16[1]);
+
+			cv::v_int32 s32[4], h32[4];
+			for(int k = 0; k < 2; k++) {
+
+				// h = vr ? g - b : vg ? b - r + 2 * diff : r - g + 4 * diff
+				cv::v_int16 bs = cv::v_reinterpret_as_s16(b16[k]);
+				cv::v_int16 gs = cv::v_reinterpret_as_s16(g16[k]);
+				cv::v_int16 rs = cv::v_reinterpret_as_s16(r16[k]);
+				cv::v_int16 ds = cv::v_reinterpret_as_s16(diff16[k]);
+				cv::v_int16 hr = cv::v_sub(gs, bs);
+				cv::v_int16 hg = cv::v_add(cv::v_sub(bs, rs), cv::v_shl<1>(ds));
+				cv::v_int16 hb = cv::v_add(cv::v_sub(rs, gs), cv::v_shl<2>(ds));
+				cv::v_int16 vs = cv::v_reinterpret_as_s16(v16[k]);
+				cv::v_int16 h16 = cv::v_select(cv::v_eq(vs, rs), hr, cv::v_select(cv::v_eq(vs, gs), hg, hb));
+
+				cv::v_int32 vPart[2], diffPart[2], hPart[2];
+				cv::v_expand(vs, vPart[0], vPart[1]);
+				cv::v_expand(ds, diffPart[0], diffPart[1]);
+				cv::v_expand(h16, hPart[0], hPart[1]);
+
+				for(int q = 0; q < 2; q++) {
+
+					int n = k * 2 + q;
+
+					// s = (diff * sdiv[v] + round) >> 12
+					cv::v_store_aligned(indices, vPart[q]);
+					cv::v_int32 sdiv = cv::vx_lut(sdivTable, indices);
+					s32[n] = cv::v_shr<12>(cv::v_add(cv::v_mul(diffPart[q], sdiv), vRound));
+
+					// h = (h * hdiv[diff] + round) >> 12, negative hues wrap around
+					cv::v_store_aligned(indices, diffPart[q]);
+					cv::v_int32 hdiv = cv::vx_lut(hdivTable, indices);
+					cv::v_int32 h = cv::v_shr<12>(cv::v_add(cv::v_mul(hPart[q], hdiv), vRound));
+					h32[n] = cv::v_add(h, cv::v_and(cv::v_lt(h, vZero32), vHueRange));
+				}
+			}
+
+			cv::v_uint8 s = cv::v_pack_u(cv::v_pack(s32[0], s32[1]), cv::v_pack(s32[2], s32[3]));
+			cv::v_uint8 hue = cv::v_pack_u(cv::v_pack(h32[0], h32[1]), cv::v_pack(h32[2], h32[3]));
+			cv::v_uint8 inv = cv::v_not(v);
+
+			// classes in reverse priority, later masks win
+			cv::v_uint8 isSaturated = cv::v_and(cv::v_gt(s, inv), cv::v_and(cv::v_gt(s, v70), cv::v_gt(inv, v60)));
+			cv::v_uint8 isLight = cv::v_and(cv::v_ge(inv, vLight), vLightOn);
+			cv::v_uint8 isDark = cv::v_and(cv::v_and(cv::v_le(inv, vDark), cv::v_le(s, vDark)), vDarkOn);
+			cv::v_uint8 isGray = cv::v_and(cv::v_gt(r, v150), cv::v_and(cv::v_lt(cv::v_absdiff(r, g), v10), cv::v_lt(cv::v_absdiff(g, b), v20)));
+			cv::v_uint8 isRedHue = cv::v_or(cv::v_and(cv::v_le(hue, vHueLow), vHueLowOn), cv::v_and(cv::v_ge(hue, vHueHigh), vHueHighOn));
+			cv::v_uint8 isRed = cv::v_and(cv::v_and(cv::v_gt(r, v50), isRedHue), cv::v_and(cv::v_gt(inv, v50), cv::v_gt(s, v50)));
+
+			cv::v_uint8 out = cv::v_select(cv::v_or(isSaturated, isLight), v255, inv);
+			out = cv::v_select(cv::v_or(isDark, cv::v_or(isGray, isRed)), vZero, out);
+
+			cv::v_store(value + j, out);
+			cv::v_store(streets + j, isRed);
+		}
+	#endif
+
+		// remaining pixels
+		for(; j < width; j++) {
+			classifyPixel(bgr[j * 3], bgr[j * 3 + 1], bgr[j * 3 + 2], value[j], streets[j]);
+		}
+	}
+
+
+	/**
+	 * Scalar version of the SIMD path with the integer HSV conversion of OpenCV.
+	 */
+
+	void PSPixelClassifier::classifyPixel(int b, int g, int r, uchar &value, uchar &street) {
+
+		int v = std::max(b, std::max(g, r));
+		int diff = v - std::min(b, std::min(g, r));
+		int s = (diff * sdivTable[v] + (1 << 11)) >> 12;
+		int h = v == r ? g - b : v == g ? b - r + 2 * diff : r - g + 4 * diff;
+		h = (h * hdivTable[diff] + (1 << 11)) >> 12;
+		if(h < 0) { h += 180; }
+
+		int inv = 255 - v;
+		bool isRed = r > 50 && (h < hueLow || h > hueHigh) && inv > 50 && s > 50;
+
+		street = isRed ? 255 : 0;
+		if(isRed) { value = 0; }
+		else if(r > 150 && abs(r - g) < 10 && abs(g - b) < 20) { value = 0; }
+		else if(inv < thresholdDark && s < thresholdDark) { value = 0; }
+		else if(inv > thresholdLight) { value = 255; }
+		else if(s > inv && s > 70 && inv > 60) { value = 255; }
+		else { value = inv; }
+	}
+
+
+	/**
+	 * Original implementation, used to validate classify().
+	 */
+
+	void PSPixelClassifier::classifyReference(cv::Mat image, cv::Mat &value, cv::Mat &streets) {
+
+		// convert rgb to hsv
+		cv::Mat matHsv;
+		cv::cvtColor(image, matHsv, cv::COLOR_BGR2HSV);
+
+		// split hsv channels
+		std::vector<cv::Mat> hsv;
+		cv::split(matHsv, hsv);
+		cv::Mat hue = hsv[0];
+		cv::Mat saturation = hsv[1];
+		value = hsv[2];
+		
+		// streets are detected by red pixels
+		streets.create(value.size(), CV_8UC1);
+		streets.setTo(cv::Scalar(0));
+		
+		// optimize vue channel
+		cv::bitwise_not(value, value); // invert image for better thresholding
+		for(int i = 0; i < value.rows; i++) {
+			for(int j = 0; j < value.cols; j++) {
+				
+				// hsv values
+				int valHue = hue.at<uchar>(i, j);
+				int valSat = saturation.at<uchar>(i, j);
+				int valVal = value.at<uchar>(i, j);
+				
+				// rgb values
+				int r = image.at<cv::Vec3b>(i, j)[2];
+				int g = image.at<cv::Vec3b>(i, j)[1];
+				int b = image.at<cv::Vec3b>(i, j)[0];
+
+				// extract red pixels for streets
+				float range = thresholdRed/255.0 * 50;
+				bool isRed = r > 50 && (valHue < range || valHue > 180 - range) && valVal > 50 && valSat > 50;
+				if(isRed) { 
+					streets.at<uchar>(i, j) = 255; 
+					value.at<uchar>(i, j) = 0;
+				}
+
+				// remove gray pixels
+				else if(r > 150 && abs(r - g) < 10 &&abs(g - b) < 20) { value.at<uchar>(i, j) = 0; }
+				// remove dark pixels
+				else if(valVal < thresholdDark && valSat < thresholdDark) { value.at<uchar>(i, j) = 0; }
+				// add light pixels
+				else if(valVal > thresholdLight) { value.at<uchar>(i, j) = 255; }
+				// prefer saturation if higher than value
+				else if(valSat > valVal && valSat > 70 && valVal > 60) { value.at<uchar>(i, j) = 255; }
+			}
+		}
+	}
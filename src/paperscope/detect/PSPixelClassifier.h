@@ -0,0 +1,60 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Classifies the pixels of a BGR plane into the inverted value channel used for thresholding and a
+ * mask of red street pixels. classify() reads every pixel once and only computes the hue and
+ * saturation terms of OpenCV's 8-bit HSV conversion in SIMD registers. classifyReference() is the
+ * original cvtColor/per-pixel implementation, both give the same output.
+ */
+
+class PSPixelClassifier {
+
+	public:
+
+		PSPixelClassifier();
+
+		// thresholds
+		void setThresholds(int dark, int light, int red);
+
+		// classification
+		void classify(cv::Mat image, cv::Mat &value, cv::Mat &streets);
+		void classifyReference(cv::Mat image, cv::Mat &value, cv::Mat &streets);
+
+
+	private:
+
+		// thresholds
+		int thresholdDark;
+		int thresholdLight;
+		int thresholdRed;
+		int hueLow;
+		int hueHigh;
+
+		// hsv
+		static void initTables();
+		static int sdivTable[256];
+		static int hdivTable[256];
+
+		// classification
+		void classifyRow(const uchar *bgr, uchar *value, uchar *streets, int width);
+		void classifyPixel(int b, int g, int r, uchar &value, uchar &street);
+};
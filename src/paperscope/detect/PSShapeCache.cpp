@@ -0,0 +1,172 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSShapeCache.h"
+
+	// C++
+	#include <algorithm>
+	#include <bitset>
+	#include <cstdlib>
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSShapeCache::PSShapeCache()
+		: tolerance(3),
+		  maxDistance(4),
+		  votes(3),
+		  maxAge(60),
+		  frame(0)
+	{
+
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	LOOKUP
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Entry of the shape at rect, binary is the threshold image in the same coordinates. Shapes that were
+	 * not found, or whose hash differs in more than maxDistance bits, start a new vote. isClassified is
+	 * true if the label of the entry can be used without inference.
+	 */
+
+	int PSShapeCache::lookup(cv::Rect rect, const cv::Mat &binary, bool &isClassified) {
+
+		uint64_t hash = fingerprint(binary(rect));
+
+		// closest hash of the entries at the same place, every entry is used once per frame
+		int best = -1;
+		size_t bestDistance = 65;
+		for(size_t i = 0; i < entries.size(); i++) {
+			if(entries[i].lastSeen == frame || !isNear(entries[i].rect, rect)) { continue; }
+			size_t distance = std::bitset<64>(entries[i].hash ^ hash).count();
+			if(distance < bestDistance) {
+				best = (int) i;
+				bestDistance = distance;
+			}
+		}
+
+		if(best < 0) {
+			entries.push_back({rect, hash, {}, PSShapeType::Rectangle, frame});
+			isClassified = false;
+			return (int) entries.size() - 1;
+		}
+
+		Entry &entry = entries[best];
+		entry.rect = rect;
+		entry.lastSeen = frame;
+
+		// changed shape, the hash is the reference for the next frames
+		if((int) bestDistance > maxDistance) {
+			entry.hash = hash;
+			entry.history.clear();
+		}
+
+		isClassified = (int) entry.history.size() >= votes;
+		return best;
+	}
+
+
+	/**
+	 * Add the result of an inference. The label is the most frequent class, a tie keeps the current label.
+	 */
+
+	void PSShapeCache::vote(int entry, PSShapeType type) {
+
+		Entry &target = entries[entry];
+		target.history.push_back(type);
+
+		int labelCount = (int) std::count(target.history.begin(), target.history.end(), target.label);
+		for(PSShapeType candidate : target.history) {
+			int count = (int) std::count(target.history.begin(), target.history.end(), candidate);
+			if(count > labelCount) {
+				target.label = candidate;
+				labelCount = count;
+			}
+		}
+	}
+
+
+	PSShapeType PSShapeCache::getLabel(int entry) {
+
+		return entries[entry].label;
+	}
+
+
+	int PSShapeCache::getVotes(int entry) {
+
+		return (int) entries[entry].history.size();
+	}
+
+
+	/**
+	 * Close the current frame. Entries that were not seen for maxAge frames are removed, entry indices are
+	 * only valid until this call.
+	 */
+
+	void PSShapeCache::nextFrame() {
+
+		entries.erase(std::remove_if(entries.begin(), entries.end(), [this](const Entry &entry) {
+			return frame - entry.lastSeen > maxAge;
+		}), entries.end());
+
+		frame++;
+	}
+
+
+	void PSShapeCache::clear() {
+
+		entries.clear();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	ENTRIES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Threshold of the shape downsampled to 8x8, one bit per cell.
+	 */
+
+	uint64_t PSShapeCache::fingerprint(const cv::Mat &roi) {
+
+		cv::Mat cells;
+		cv::resize(roi, cells, cv::Size(8, 8), 0, 0, cv::INTER_AREA);
+
+		uint64_t hash = 0;
+		for(int y = 0; y < 8; y++) {
+			const uchar *row = cells.ptr<uchar>(y);
+			for(int x = 0; x < 8; x++) {
+				if(row[x] > 127) { hash |= (uint64_t) 1 << (y * 8 + x); }
+			}
+		}
+
+		return hash;
+	}
+
+
+	bool PSShapeCache::isNear(cv::Rect a, cv::Rect b) {
+
+		return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance &&
+			std::abs(a.width - b.width) <= tolerance && std::abs(a.height - b.height) <= tolerance;
+	}
@@ -0,0 +1,72 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <cstdint>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// App
+	#include "PSShapeType.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Remembers the class of every shape on the table. A shape is found again by its bounding box and a 64 bit
+ * hash of the threshold downsampled to 8x8. New or changed shapes are classified on the next frames until
+ * enough votes are collected, the majority is kept as label. After that the shape is not classified again
+ * until its hash changes.
+ */
+
+class PSShapeCache {
+
+	public:
+
+		PSShapeCache();
+
+		// lookup
+		int lookup(cv::Rect rect, const cv::Mat &binary, bool &isClassified);
+		void vote(int entry, PSShapeType type);
+		PSShapeType getLabel(int entry);
+		int getVotes(int entry);
+		void nextFrame();
+		void clear();
+
+		// settings
+		int tolerance;
+		int maxDistance;
+		int votes;
+		int maxAge;
+
+
+	private:
+
+		struct Entry {
+			cv::Rect rect;
+			uint64_t hash;
+			std::vector<PSShapeType> history;
+			PSShapeType label;
+			int lastSeen;
+		};
+
+		// entries
+		uint64_t fingerprint(const cv::Mat &roi);
+		bool isNear(cv::Rect a, cv::Rect b);
+		std::vector<Entry> entries;
+		int frame;
+};
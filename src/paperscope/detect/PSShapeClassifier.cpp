@@ -0,0 +1,354 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#include "PSShapeClassifier.h"
+
+	// C++
+	#include <algorithm>
+	#include <cmath>
+	#include <limits>
+
+	// Qt
+	#include <QDebug>
+
+	// Tensorflow
+	#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CONSTRUCTOR
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	PSShapeClassifier::PSShapeClassifier()
+		: model(nullptr),
+		  resolver(nullptr),
+		  interpreter(nullptr),
+		  variant({"", false, 1}),
+		  inputType(CV_32FC1),
+		  inputAlpha(1.0 / 255.0),
+		  inputBeta(0.0),
+		  isDirectInput(false),
+		  batchSize(1),
+		  isBatchSupported(true)
+	{
+
+	}
+
+
+	PSShapeClassifier::~PSShapeClassifier() {
+
+		release();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	VARIANTS
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Load the model of a variant and build its interpreter for the batch size of the model. Quantized inputs
+	 * are filled with the 0..255 threshold values, a uint8 input with a scale of 1/255 takes them without
+	 * conversion.
+	 */
+
+	bool PSShapeClassifier::load(Variant newVariant) {
+
+		release();
+
+		model = tflite::FlatBufferModel::BuildFromFile(newVariant.path.c_str());
+		if(!model) { return false; }
+		resolver = new tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates();
+
+		std::unique_ptr<tflite::Interpreter> built = build(newVariant, 0);
+		if(!built) {
+			release();
+			return false;
+		}
+
+		// input in the type of the model, real value = (q - zeroPoint) * scale
+		TfLiteTensor *input = built->input_tensor(0);
+		if(input->type == kTfLiteFloat32) {
+			inputType = CV_32FC1;
+			inputAlpha = 1.0 / 255.0;
+			inputBeta = 0.0;
+		}
+		else if((input->type == kTfLiteUInt8 || input->type == kTfLiteInt8) && input->params.scale > 0) {
+			inputType = input->type == kTfLiteUInt8 ? CV_8UC1 : CV_8SC1;
+			inputAlpha = 1.0 / (255.0 * input->params.scale);
+			inputBeta = input->params.zero_point;
+		}
+		else {
+			qDebug() << "classifier: unsupported input type" << input->type;
+			release();
+			return false;
+		}
+		isDirectInput = inputType == CV_8UC1 && inputBeta == 0.0 && std::abs(inputAlpha - 1.0) < 1e-3;
+
+		variant = newVariant;
+		batchSize = input->dims->data[0];
+		isBatchSupported = true;
+		interpreter = built.get();
+		interpreters[batchSize] = std::move(built);
+
+		return true;
+	}
+
+
+	/**
+	 * Measure every variant and load the fastest one. A frame usually has only a few new shapes, variants are
+	 * compared by their mean latency of a call with 1, 2 and 4 shapes. Variants that fail to load, e.g. a
+	 * missing int8 model, are skipped.
+	 */
+
+	bool PSShapeClassifier::select(std::vector<Variant> variants, int runs) {
+
+		Variant fastest = variants.empty() ? variant : variants[0];
+		double fastestTime = std::numeric_limits<double>::max();
+
+		for(Variant &candidate : variants) {
+
+			if(!load(candidate)) {
+				qDebug() << "classifier: could not load" << describe(candidate).c_str();
+				continue;
+			}
+
+			double single = measure(runs, 1);
+			double pair = measure(runs, 2);
+			double quad = measure(runs, 4);
+			double time = (single + pair + quad) / 3.0;
+			qDebug() << "classifier:" << describe(candidate).c_str() << "ms per call at batch 1/2/4:" << single << pair << quad;
+
+			if(time < fastestTime) {
+				fastest = candidate;
+				fastestTime = time;
+			}
+		}
+
+		if(fastestTime == std::numeric_limits<double>::max()) {
+			release();
+			return false;
+		}
+
+		qDebug() << "classifier: using" << describe(fastest).c_str();
+
+		return load(fastest);
+	}
+
+
+	/**
+	 * Average time in milliseconds to classify count shapes, a single call if the model supports batches.
+	 * The first inference is not measured, XNNPACK sets up its operators on the first run.
+	 */
+
+	double PSShapeClassifier::measure(int runs, int count) {
+
+		if(!interpreter) { return std::numeric_limits<double>::max(); }
+
+		int batch = resizeBatch(count);
+		int calls = (count + batch - 1) / batch;
+		inputBatch(batch).setTo(inputBeta);
+		interpreter->Invoke();
+
+		int64 start = cv::getTickCount();
+		for(int i = 0; i < runs * calls; i++) { interpreter->Invoke(); }
+		double elapsed = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+
+		return elapsed / std::max(runs, 1);
+	}
+
+
+	std::string PSShapeClassifier::describe(Variant variant) {
+
+		std::string name = variant.path.substr(variant.path.find_last_of("/\\") + 1);
+		return name + (variant.xnnpack ? " xnnpack" : " builtin") + " threads " + std::to_string(variant.threads);
+	}
+
+
+	/**
+	 * Interpreter of the loaded model, batch 0 keeps the batch size of the model. Default delegates are
+	 * disabled, XNNPACK is only applied if the variant asks for it. The input is resized before the delegate
+	 * is applied, so XNNPACK plans its operators for the final shape.
+	 */
+
+	std::unique_ptr<tflite::Interpreter> PSShapeClassifier::build(Variant buildVariant, int batch) {
+
+		std::unique_ptr<tflite::Interpreter> built;
+		tflite::InterpreterBuilder builder(*model, *resolver);
+		builder.SetNumThreads(buildVariant.threads);
+		if(builder(&built) != kTfLiteOk || !built) { return nullptr; }
+
+		if(batch > 0) {
+			int inputIndex = built->inputs()[0];
+			TfLiteTensor *inputTensor = built->tensor(inputIndex);
+			std::vector<int> dims(inputTensor->dims->data, inputTensor->dims->data + inputTensor->dims->size);
+			dims[0] = batch;
+			if(built->ResizeInputTensor(inputIndex, dims) != kTfLiteOk) { return nullptr; }
+		}
+
+		if(buildVariant.xnnpack) {
+			TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+			options.num_threads = buildVariant.threads;
+			options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QS8 | TFLITE_XNNPACK_DELEGATE_FLAG_QU8;
+			tflite::Interpreter::TfLiteDelegatePtr delegate(TfLiteXNNPackDelegateCreate(&options), TfLiteXNNPackDelegateDelete);
+			if(built->ModifyGraphWithDelegate(std::move(delegate)) != kTfLiteOk) { return nullptr; }
+		}
+
+		if(built->AllocateTensors() != kTfLiteOk) { return nullptr; }
+
+		return built;
+	}
+
+
+	void PSShapeClassifier::release() {
+
+		interpreter = nullptr;
+		interpreters.clear();
+		delete resolver;
+		resolver = nullptr;
+		model.reset();
+	}
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASSIFICATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	/**
+	 * Classify the rects of the threshold image in batches. Every 64x64 input is written straight into the
+	 * tensor through a cv::Mat header, unused batch slots stay black. The batch of every call is chosen for
+	 * the remaining shapes, 3 shapes run as a batch of 4. Returns the number of inferences.
+	 */
+
+	int PSShapeClassifier::classify(const cv::Mat &image, const std::vector<cv::Rect> &rects, std::vector<PSShapeType> &types) {
+
+		types.assign(rects.size(), PSShapeType::Rectangle);
+		if(!interpreter || rects.empty()) { return 0; }
+
+		int count = (int) rects.size();
+		int calls = 0;
+		int batch = 1;
+
+		for(int first = 0; first < count; first += batch) {
+
+			batch = resizeBatch(count - first);
+			int n = std::min(batch, count - first);
+
+			cv::Mat input = inputBatch(batch);
+			input.setTo(inputBeta);
+
+			for(int k = 0; k < n; k++) {
+
+				// padding of 5 pixels
+				cv::Mat inner = input(cv::Rect(5, k * 64 + 5, 54, 54));
+				if(isDirectInput) {
+					cv::resize(image(rects[first + k]), inner, cv::Size(54, 54));
+				}
+				else {
+					cv::Mat roi;
+					cv::resize(image(rects[first + k]), roi, cv::Size(54, 54));
+					roi.convertTo(inner, inputType, inputAlpha, inputBeta);
+				}
+			}
+
+			// run inference
+			interpreter->Invoke();
+			calls++;
+
+			TfLiteTensor *output = interpreter->output_tensor(0);
+			int classes = output->dims->data[output->dims->size - 1];
+			for(int k = 0; k < n; k++) {
+				types[first + k] = (PSShapeType) bestClass(k, classes);
+			}
+		}
+
+		return calls;
+	}
+
+
+	/**
+	 * Switch to the interpreter for count shapes, the next power of two up to 16. Interpreters are built
+	 * on first use and kept, switching sizes never reallocates tensors. Models with a fixed batch size
+	 * return their own batch size.
+	 */
+
+	int PSShapeClassifier::resizeBatch(int count) {
+
+		if(!isBatchSupported) { return batchSize; }
+
+		int capacity = 1;
+		while(capacity < count && capacity < 16) { capacity *= 2; }
+
+		auto cached = interpreters.find(capacity);
+		if(cached != interpreters.end()) {
+			interpreter = cached->second.get();
+			batchSize = capacity;
+			return batchSize;
+		}
+
+		std::unique_ptr<tflite::Interpreter> built = build(variant, capacity);
+		if(built && built->output_tensor(0)->dims->data[0] == capacity) {
+			interpreter = built.get();
+			interpreters[capacity] = std::move(built);
+			batchSize = capacity;
+			return batchSize;
+		}
+
+		// the interpreter built by load() is the only one left, it keeps the batch size of the model
+		qDebug() << "classifier: model does not support batches";
+		isBatchSupported = false;
+		auto original = interpreters.begin();
+		interpreter = original->second.get();
+		batchSize = original->first;
+
+		return batchSize;
+	}
+
+
+	/**
+	 * Header of the input tensor with the 64x64 slots stacked vertically.
+	 */
+
+	cv::Mat PSShapeClassifier::inputBatch(int batch) {
+
+		return cv::Mat(batch * 64, 64, inputType, interpreter->input_tensor(0)->data.raw);
+	}
+
+
+	/**
+	 * Highest score of the first five classes of a slot. Quantized scores have a positive scale, the raw
+	 * values are compared.
+	 */
+
+	int PSShapeClassifier::bestClass(int slot, int classes) {
+
+		TfLiteTensor *output = interpreter->output_tensor(0);
+		int count = std::min(classes, 5);
+
+		if(output->type == kTfLiteUInt8) {
+			uint8_t *scores = output->data.uint8 + slot * classes;
+			return (int) (std::max_element(scores, scores + count) - scores);
+		}
+		if(output->type == kTfLiteInt8) {
+			int8_t *scores = output->data.int8 + slot * classes;
+			return (int) (std::max_element(scores, scores + count) - scores);
+		}
+
+		float *scores = output->data.f + slot * classes;
+		return (int) (std::max_element(scores, scores + count) - scores);
+	}
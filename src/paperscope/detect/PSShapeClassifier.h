@@ -0,0 +1,89 @@
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	INCLUDES
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+	#pragma once
+
+	// C++
+	#include <map>
+	#include <memory>
+	#include <string>
+	#include <vector>
+
+	// OpenCV
+	#include <opencv2/opencv.hpp>
+
+	// Tensorflow
+	#include "tensorflow/lite/kernels/register.h"
+	#include "tensorflow/lite/model.h"
+	#include "tensorflow/lite/interpreter.h"
+
+	// App
+	#include "PSShapeType.h"
+
+
+
+/*///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CLASS DECLARATION
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////// */
+
+
+/**
+ * Shape classifier on top of a TensorFlow Lite interpreter. A variant combines a model file, float or
+ * int8 quantized, with the XNNPACK delegate and a thread count. select() measures every variant on the
+ * current CPU and keeps the fastest. Rects passed to classify() run in batches of 1, 2, 4, 8 or 16 shapes,
+ * every batch size has its own interpreter which is built on first use and kept.
+ */
+
+class PSShapeClassifier {
+
+	public:
+
+		struct Variant {
+			std::string path;
+			bool xnnpack;
+			int threads;
+		};
+
+		PSShapeClassifier();
+		~PSShapeClassifier();
+
+		// variants
+		bool load(Variant newVariant);
+		bool select(std::vector<Variant> variants, int runs = 20);
+		double measure(int runs, int batch = 1);
+		static std::string describe(Variant variant);
+
+		// classification
+		int classify(const cv::Mat &image, const std::vector<cv::Rect> &rects, std::vector<PSShapeType> &types);
+
+
+	private:
+
+		// interpreter
+		std::unique_ptr<tflite::Interpreter> build(Variant buildVariant, int batch);
+		void release();
+		tflite::impl::FlatBufferModel::Ptr model;
+		tflite::ops::builtin::BuiltinOpResolver *resolver;
+		std::map<int, std::unique_ptr<tflite::Interpreter>> interpreters;
+		tflite::Interpreter *interpreter;
+		Variant variant;
+
+		// input
+		int resizeBatch(int count);
+		cv::Mat inputBatch(int batch);
+		int inputType;
+		double inputAlpha;
+		double inputBeta;
+		bool isDirectInput;
+		int batchSize;
+		bool isBatchSupported;
+
+		// output
+		int bestClass(int slot, int classes);
+};
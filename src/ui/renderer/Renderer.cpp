@@ -125,15 +125,16 @@
 
 	/**
 	 * A loop function that gets called every frame to update ui and renderer. Triggerd by PaperScope::updated signal.
+	 * The mat is already composed at view size, scaling maps frame coordinates to view coordinates.
 	 */
 
-	void Renderer::update(cv::Mat mat, std::vector<cv::Point2f> points) {
+	void Renderer::update(cv::Mat mat, std::vector<cv::Point2f> points, float viewScaling) {
 
 		if(renderMode == RenderMode::Camera) {
-			updateRenderer(mat, points);
+			updateRenderer(mat, points, viewScaling);
 		}
 		else if(renderMode == RenderMode::PaperScope) {
-			updateRenderer(mat, points);
+			updateRenderer(mat, points, viewScaling);
 		}
 	}
 
@@ -160,30 +161,13 @@
 	}
 
 
-	void Renderer::updateRenderer(cv::Mat &mat, std::vector<cv::Point2f> points) {
+	void Renderer::updateRenderer(cv::Mat &mat, std::vector<cv::Point2f> points, float viewScaling) {
 
 		if(mat.empty()) { return; }
 
-		int w = mat.cols;
-		int h = mat.rows;
-		int ww = renderView.width();
-		int wh = renderView.height();
-
-		// scale image to fit viewport in cover mode (720x405)
-		QImage image = QImage(mat.data, w, h, QImage::Format_RGB888).rgbSwapped();
-		if(w/h < ww/wh) { 
-			scaling = ww*1.0f/w;
-			w = ww; 
-			h *= scaling; 
-		}
-		else { 
-			scaling = wh*1.0f/h;
-			h = wh; 
-			w *= scaling; 
-		}
-		if(w==0 || h==0) { return; }
-
-		image = image.scaled(w, h, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		// image is composed by PSRenderLayer to fit viewport in cover mode (720x405)
+		scaling = viewScaling;
+		QImage image = QImage(mat.data, mat.cols, mat.rows, mat.step, QImage::Format_RGB888).rgbSwapped();
 
 		// draw lines between corner points
 		if(renderMode == RenderMode::Camera) {
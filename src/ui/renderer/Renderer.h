@@ -56,7 +56,7 @@ class Renderer : public QWidget {
 
 		// renderer
 		void initRenderer();
-		void updateRenderer(cv::Mat &mat, std::vector<cv::Point2f> points);
+		void updateRenderer(cv::Mat &mat, std::vector<cv::Point2f> points, float viewScaling);
 		RenderMode renderMode;
 		QGraphicsView renderView;
 		QGraphicsScene renderScene;
@@ -100,7 +100,7 @@ class Renderer : public QWidget {
 		void stopManualCalibrate();
 
 		// processing
-		void update(cv::Mat mat, std::vector<cv::Point2f> points);
+		void update(cv::Mat mat, std::vector<cv::Point2f> points, float viewScaling);
 
 		// settings
 		void onSettingsUpdated(QString key, QVariant value);